@@ -0,0 +1,303 @@
+#include "AcronymTable.h"
+
+/*****************************************************************************
+ Title:             AcronymTable.cpp
+ Created on:        October 18, 2026
+ Description:       Implementation of AcronymTable and AcronymSet functions
+
+ *****************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Bytes of acronym text per block of the arena
+static const size_t BLOCK_BYTES = 64 << 10;
+
+// Marks a free slot of the hash table
+static const uint32_t NO_ID = UINT32_MAX;
+
+// The empty acronym of a query always has this id
+static const uint32_t EMPTY_ID = 0;
+
+// Name block b holds FIRST_NAMES << b names, so 23 blocks hold every id
+static const int FIRST_NAMES_BITS = 10;
+static const uint64_t FIRST_NAMES = uint64_t(1) << FIRST_NAMES_BITS;
+static const int NAME_BLOCKS = 32 - FIRST_NAMES_BITS + 1;
+
+/**
+* Returns the position of the highest set bit of x, which is not 0
+*/
+static int highestBit(uint64_t x) {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(x);
+#else
+    int bit = 0;
+    while (x >>= 1) {
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+/**
+* The interned acronyms. Their text is packed into blocks that are never
+* moved or freed, so the views in names stay valid as the table grows.
+* The views themselves are kept in blocks that double in size and are
+* never moved either. A name is written before count is raised past its
+* id with a release store, so name() reads it without taking the lock.
+* slots is an open-addressing hash table of ids, at most half full. It and
+* the arena are only used under lock.
+*/
+struct Interned {
+    vector<unique_ptr<char[]>> blocks;
+    size_t blockUsed = BLOCK_BYTES;
+    unique_ptr<string_view[]> names[NAME_BLOCKS];
+    atomic<uint32_t> count{0};
+    vector<uint32_t> slots = vector<uint32_t>(1024, NO_ID);
+    mutex lock;
+
+    Interned() {
+        add("");    // EMPTY_ID
+    }
+
+    // Returns the view of the name with the given id
+    string_view &name(uint32_t id) const {
+        uint64_t pos = id + FIRST_NAMES;
+        int bit = highestBit(pos);
+        return names[bit - FIRST_NAMES_BITS][pos - (uint64_t(1) << bit)];
+    }
+
+    // Returns the slot holding acronym, or the free slot where it belongs
+    size_t find(string_view acronym) const {
+        size_t mask = slots.size() - 1;
+        size_t slot = hash<string_view>()(acronym) & mask;
+        while (slots[slot] != NO_ID && name(slots[slot]) != acronym) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    // Copies acronym into the arena and returns a view of the copy. The
+    // empty acronym needs no text, and comes before any block is allocated
+    string_view store(string_view acronym) {
+        if (acronym.empty()) {
+            return string_view();
+        }
+        if (acronym.size() > BLOCK_BYTES - blockUsed) {
+            blocks.emplace_back(new char[max(BLOCK_BYTES, acronym.size())]);
+            blockUsed = 0;
+        }
+        char *text = blocks.back().get() + blockUsed;
+        memcpy(text, acronym.data(), acronym.size());
+        blockUsed += acronym.size();
+        return string_view(text, acronym.size());
+    }
+
+    // Returns the id of acronym, adding it if it is new. Called under lock.
+    uint32_t add(string_view acronym) {
+        size_t slot = find(acronym);
+        if (slots[slot] != NO_ID) {
+            return slots[slot];
+        }
+        uint32_t id = count.load(memory_order_relaxed);
+        uint64_t pos = id + FIRST_NAMES;
+        int bit = highestBit(pos);
+        if (pos == (uint64_t(1) << bit)) {
+            names[bit - FIRST_NAMES_BITS].reset(new string_view[pos]);
+        }
+        name(id) = store(acronym);
+        count.store(id + 1, memory_order_release);
+        slots[slot] = id;
+        if (2 * (uint64_t(id) + 1) > slots.size()) {
+            grow();
+        }
+        return id;
+    }
+
+    // Doubles the hash table and reinserts every id
+    void grow() {
+        slots.assign(2 * slots.size(), NO_ID);
+        uint32_t n = count.load(memory_order_relaxed);
+        for (uint32_t id = 0; id < n; id++) {
+            slots[find(name(id))] = id;
+        }
+    }
+};
+
+static Interned &table() {
+    static Interned interned;
+    return interned;
+}
+
+uint32_t AcronymTable::intern(string_view acronym) {
+    if (acronym.empty()) {
+        return EMPTY_ID;
+    }
+    Interned &t = table();
+    lock_guard<mutex> guard(t.lock);
+    return t.add(acronym);
+}
+
+/**
+* Interns every acronym under one lock, so threads parsing chunks of a file
+* take it once per chunk rather than once per acronym
+*/
+void AcronymTable::intern(const vector<string_view> &acronyms, vector<uint32_t> &ids) {
+    Interned &t = table();
+    ids.resize(acronyms.size());
+    lock_guard<mutex> guard(t.lock);
+    for (size_t i = 0; i < acronyms.size(); i++) {
+        // An enzyme with several sequences gives a run of the same acronym
+        if (i > 0 && acronyms[i] == acronyms[i-1]) {
+            ids[i] = ids[i-1];
+        }
+        else {
+            ids[i] = t.add(acronyms[i]);
+        }
+    }
+}
+
+/**
+* Reads the name without locking: count is loaded with acquire, so every
+* name published before it is visible, and its block never moves
+*/
+string_view AcronymTable::name(uint32_t id) {
+    Interned &t = table();
+    t.count.load(memory_order_acquire);
+    return t.name(id);
+}
+
+size_t AcronymTable::size() {
+    return table().count.load(memory_order_acquire);
+}
+
+AcronymSet::AcronymSet(const AcronymSet &rhs):count(0), capacity(INLINE_IDS) {
+    reserve(rhs.count);
+    memcpy(data(), rhs.begin(), rhs.count * sizeof(uint32_t));
+    count = rhs.count;
+}
+
+AcronymSet::AcronymSet(AcronymSet &&rhs) noexcept:count(rhs.count), capacity(rhs.capacity) {
+    if (capacity == INLINE_IDS) {
+        memcpy(local, rhs.local, sizeof(local));
+    }
+    else {
+        heap = rhs.heap;
+    }
+    rhs.count = 0;
+    rhs.capacity = INLINE_IDS;
+}
+
+AcronymSet &AcronymSet::operator= (const AcronymSet &rhs) {
+    if (this != &rhs) {
+        count = 0;
+        reserve(rhs.count);
+        memcpy(data(), rhs.begin(), rhs.count * sizeof(uint32_t));
+        count = rhs.count;
+    }
+    return *this;
+}
+
+AcronymSet &AcronymSet::operator= (AcronymSet &&rhs) noexcept {
+    if (this != &rhs) {
+        if (capacity != INLINE_IDS) {
+            delete [] heap;
+        }
+        count = rhs.count;
+        capacity = rhs.capacity;
+        if (capacity == INLINE_IDS) {
+            memcpy(local, rhs.local, sizeof(local));
+        }
+        else {
+            heap = rhs.heap;
+        }
+        rhs.count = 0;
+        rhs.capacity = INLINE_IDS;
+    }
+    return *this;
+}
+
+AcronymSet::~AcronymSet() {
+    if (capacity != INLINE_IDS) {
+        delete [] heap;
+    }
+}
+
+/**
+* Grows the storage to hold at least n ids, doubling each time
+*/
+void AcronymSet::reserve(uint32_t n) {
+    if (n <= capacity) {
+        return;
+    }
+    uint32_t grown = max(n, 2 * capacity);
+    uint32_t *ids = new uint32_t[grown];
+    memcpy(ids, data(), count * sizeof(uint32_t));
+    if (capacity != INLINE_IDS) {
+        delete [] heap;
+    }
+    heap = ids;
+    capacity = grown;
+}
+
+/**
+* Inserts id at its sorted place, unless it is already in the set
+*/
+void AcronymSet::insert(uint32_t id) {
+    uint32_t *first = data();
+    uint32_t *place = lower_bound(first, first + count, id);
+    if (place != first + count && *place == id) {
+        return;
+    }
+    size_t at = place - first;
+    reserve(count + 1);
+    first = data();
+    memmove(first + at + 1, first + at, (count - at) * sizeof(uint32_t));
+    first[at] = id;
+    count++;
+}
+
+/**
+* Merges other into the set. Both are sorted, so this is one pass over
+* each from the back, writing the union in place.
+*/
+void AcronymSet::merge(const AcronymSet &other) {
+    if (other.count == 1) {
+        insert(*other.begin());
+        return;
+    }
+    if (&other == this || other.count == 0) {
+        return;
+    }
+
+    reserve(count + other.count);
+    uint32_t *ids = data();
+
+    // Union from the largest id down into the free space at the end
+    uint32_t mine = count;
+    uint32_t theirs = other.count;
+    uint32_t out = count + other.count;
+    while (theirs > 0) {
+        uint32_t id = other.begin()[theirs - 1];
+        if (mine > 0 && ids[mine - 1] >= id) {
+            if (ids[mine - 1] == id) {
+                theirs--;
+            }
+            ids[--out] = ids[--mine];
+        }
+        else {
+            ids[--out] = id;
+            theirs--;
+        }
+    }
+
+    // Ids left over in place are already sorted; close the gap duplicates left
+    uint32_t merged = count + other.count - out + mine;
+    memmove(ids + mine, ids + out, (count + other.count - out) * sizeof(uint32_t));
+    count = merged;
+}
@@ -0,0 +1,102 @@
+/*****************************************************************************
+ Title:             AcronymTable.h
+ Created on:        October 18, 2026
+ Description:       Interned enzyme acronyms.
+
+                    AcronymTable keeps one copy of each acronym and hands
+                    out a 32-bit id for it. The text of all acronyms is
+                    packed into large blocks and found through a flat hash
+                    table of ids, so an acronym costs its length plus a few
+                    words. It is shared by every SequenceMap and may be used
+                    from several threads: adding acronyms takes a lock, but
+                    looking up a name does not.
+
+                    AcronymSet is the set of acronym ids of one sequence,
+                    kept sorted by id. Most sequences have one or two
+                    enzymes, so up to INLINE_IDS ids are held in the object
+                    itself and only larger sets use the heap. Adding and
+                    merging ids are integer operations; names are looked up
+                    only when the acronyms are printed.
+
+ *****************************************************************************/
+
+#ifndef ACRONYMTABLE_H
+#define ACRONYMTABLE_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+using namespace std;
+
+class AcronymTable {
+public:
+
+    // Returns the id of acronym, adding it to the table if it is new. The
+    // empty acronym has a fixed id and takes no lock.
+    static uint32_t intern (string_view acronym);
+
+    // Sets ids[i] to the id of acronyms[i], taking the lock once for all
+    static void intern (const vector<string_view> &acronyms, vector<uint32_t> &ids);
+
+    // Returns the acronym with the given id. Stays valid for the life of
+    // the program. Takes no lock.
+    static string_view name (uint32_t id);
+
+    // Returns the number of distinct acronyms interned, counting the empty
+    // acronym
+    static size_t size ();
+};
+
+class AcronymSet {
+private:
+
+    static const uint32_t INLINE_IDS = 2;
+
+    uint32_t count;             // Number of ids in the set
+    uint32_t capacity;          // Ids that fit before growing
+    union {
+        uint32_t local[INLINE_IDS];  // Ids, while capacity is INLINE_IDS
+        uint32_t *heap;              // Ids, once the set has grown
+    };
+
+    uint32_t *data () {
+        return capacity == INLINE_IDS ? local : heap;
+    }
+
+    // Makes room for at least n ids, keeping the ones held
+    void reserve (uint32_t n);
+
+public:
+
+    AcronymSet ():count(0), capacity(INLINE_IDS) { }
+    AcronymSet (const AcronymSet &rhs);
+    AcronymSet (AcronymSet &&rhs) noexcept;
+    AcronymSet &operator= (const AcronymSet &rhs);
+    AcronymSet &operator= (AcronymSet &&rhs) noexcept;
+    ~AcronymSet ();
+
+    // Adds id to the set if it is not there already
+    void insert (uint32_t id);
+
+    // Adds every id of other to the set
+    void merge (const AcronymSet &other);
+
+    // Removes every id. Keeps any heap storage for reuse.
+    void clear () {
+        count = 0;
+    }
+
+    uint32_t size () const {
+        return count;
+    }
+
+    const uint32_t *begin () const {
+        return capacity == INLINE_IDS ? local : heap;
+    }
+
+    const uint32_t *end () const {
+        return begin() + count;
+    }
+};
+
+#endif
@@ -0,0 +1,69 @@
+#include "AllocationCounter.h"
+
+/*****************************************************************************
+ Title:             AllocationCounter.cpp
+ Created on:        October 18, 2026
+ Description:       Replacement global operator new and delete that count
+                    allocations. Arrays and the nothrow forms go through
+                    these by default, so they are counted as well. The
+                    forms for over-aligned types do not, so they are
+                    replaced too.
+
+ *****************************************************************************/
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+
+static atomic<long> allocations(0);
+static atomic<size_t> bytes_in_use(0);
+
+long heapAllocations() {
+    return allocations.load(memory_order_relaxed);
+}
+
+size_t heapBytesInUse() {
+    return bytes_in_use.load(memory_order_relaxed);
+}
+
+void *operator new(size_t size) {
+    void *p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw bad_alloc();
+    }
+    allocations.fetch_add(1, memory_order_relaxed);
+    bytes_in_use.fetch_add(malloc_usable_size(p), memory_order_relaxed);
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    if (p != nullptr) {
+        bytes_in_use.fetch_sub(malloc_usable_size(p), memory_order_relaxed);
+        free(p);
+    }
+}
+
+void operator delete(void *p, size_t) noexcept {
+    operator delete(p);
+}
+
+void *operator new(size_t size, align_val_t align) {
+    size_t alignment = static_cast<size_t>(align);
+    // aligned_alloc() needs a size that is a multiple of the alignment
+    void *p = aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (p == nullptr) {
+        throw bad_alloc();
+    }
+    allocations.fetch_add(1, memory_order_relaxed);
+    bytes_in_use.fetch_add(malloc_usable_size(p), memory_order_relaxed);
+    return p;
+}
+
+void operator delete(void *p, align_val_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void *p, size_t, align_val_t) noexcept {
+    operator delete(p);
+}
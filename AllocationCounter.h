@@ -0,0 +1,27 @@
+/*****************************************************************************
+ Title:             AllocationCounter.h
+ Created on:        October 18, 2026
+ Description:       Counts heap allocations made through operator new. A
+                    program linked with AllocationCounter.cpp has its global
+                    operator new and delete replaced by ones that keep count,
+                    so a test can check how many allocations a piece of work
+                    made by reading the counters before and after it.
+
+                    The counters are atomic, so allocations made on other
+                    threads are counted too.
+
+ *****************************************************************************/
+
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstddef>
+using namespace std;
+
+// Returns the number of calls to operator new made so far
+long heapAllocations ();
+
+// Returns the number of heap bytes allocated and not yet freed
+size_t heapBytesInUse ();
+
+#endif
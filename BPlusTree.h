@@ -0,0 +1,935 @@
+#ifndef B_PLUS_TREE_H
+#define B_PLUS_TREE_H
+
+/*****************************************************************************
+ Title:             BPlusTree.h
+ Created on:        October 18, 2026
+ Description:       Template class for a B+ tree whose nodes hold up to
+                    FANOUT keys each, so a search visits log base FANOUT of
+                    n nodes instead of the log2 n of a binary tree.
+
+                    Elements live in the leaves, which are linked left to
+                    right for walks in order. Inner nodes hold copies of the
+                    smallest key of each child but the first, to route
+                    searches.
+
+                    Every node keeps, next to its keys, a 64-bit prefix of
+                    each (see PackedSequence::prefix( )) in one array, 16
+                    of which fill two cache lines. A node is searched by a
+                    binary search of its prefixes, reading a whole key only
+                    where the prefixes are equal, so a search touches the
+                    prefix lines and one key or element per node.
+
+                    Every node but the root is at least half full. Inserting
+                    into a full node splits it in two, and a node that falls
+                    below half full after a remove borrows from a sibling,
+                    or is merged with one if the sibling has none to spare.
+
+                    Comparable must have getKey( ), as SequenceMap does,
+                    returning a key with prefix( ) and compare( ).
+
+ ****************************************************************************/
+
+#include "NodePool.h"
+#include "TreeSnapshot.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+using namespace std;
+
+// BPlusTree class
+//
+// CONSTRUCTION: zero parameter. FANOUT is the most keys a node holds, 16 by
+//               default. Nodes come from Allocator, a NodePool by default
+//               (see NodePool.h).
+//
+// ******************PUBLIC OPERATIONS*********************
+// void insert( x, count )     --> Insert x; duplicates are merged. Adds to
+//                                 count the nodes visited.
+// bool remove( x, count )     --> Removes x. Adds to count the nodes
+//                                 visited.
+// bool contains( x, count )   --> Return true if x is present; else false.
+//                                 Adds to count the nodes visited.
+// vector<bool> containsBatch( xs, count )
+//                             --> Result i is true if xs[i] is present.
+//                                 Adds to count the nodes visited.
+// boolean isEmpty( )          --> Return true if empty; else false
+// void makeEmpty( )           --> Remove all items
+// void bulkLoad( first, last ) --> Replace contents with the elements in
+//                                 [first, last); duplicates are merged.
+// void printTree( )           --> Print tree in sorted order
+// void printNode(x)           --> Prints element with the same key as x
+// void inOrder( visit )       --> Calls visit( element ) on every element
+//                                 in sorted order
+// void range( lo, hi, visit ) --> Calls visit( element ) on every element
+//                                 from lo to hi inclusive, in sorted order
+// int nodes( )                --> Returns the number of elements
+// int treeNodes( )            --> Returns the number of inner and leaf nodes
+// int internalPathLength( )   --> Returns the sum of the depth of the leaf
+//                                 of every element, the root being at 0
+// long keyComparisons( )      --> Returns the number of prefix and key
+//                                 comparisons made by insert, remove and
+//                                 contains
+// bool save( path, shape )    --> Writes the elements to a snapshot file
+//                                 (see TreeSnapshot.h). Loading packs the
+//                                 leaves anew, so shape is ignored. Returns
+//                                 false on failure.
+// bool load( path )           --> Replaces the contents with a snapshot.
+//                                 Returns false, leaving the tree as it
+//                                 was, if the file is not a valid snapshot.
+
+template <typename Comparable, int FANOUT = 16, template <typename> class Allocator = NodePool>
+class BPlusTree
+{
+    static_assert( FANOUT >= 4, "a B+ tree node must hold at least 4 keys" );
+
+public:
+
+
+/******************************************************************************
+     PUBLIC CONSTRUCTORS, DESTRUCTORS, MOVERS
+******************************************************************************/
+
+    BPlusTree( ) : root{ nullptr }, height{ 0 }, size{ 0 }, comparisons{ 0 } { }
+
+    BPlusTree( const BPlusTree & rhs ) = delete;
+    BPlusTree & operator=( const BPlusTree & rhs ) = delete;
+
+    BPlusTree( BPlusTree && rhs ) : BPlusTree( ) {
+        *this = std::move( rhs );
+    }
+
+    ~BPlusTree( ) {
+        makeEmpty( );
+    }
+
+    /**
+     * Move.
+     */
+    BPlusTree & operator=( BPlusTree && rhs ) {
+        std::swap( root, rhs.root );
+        std::swap( height, rhs.height );
+        std::swap( leaves, rhs.leaves );
+        std::swap( inners, rhs.inners );
+        std::swap( size, rhs.size );
+        std::swap( comparisons, rhs.comparisons );
+        return *this;
+    }
+
+
+/******************************************************************************
+     PUBLIC FIND FUNCTIONS
+******************************************************************************/
+
+    /**
+     * Returns true if x is found in the tree. Else returns false
+     * Counts the nodes visited
+     */
+    bool contains( const Comparable & x, int & count ) const {
+        return find( x, count ) != nullptr;
+    }
+
+    /**
+     * Returns, for each query, true if it is found in the tree
+     * Counts the nodes visited
+     */
+    vector<bool> containsBatch( const vector<Comparable> & queries, int & count ) const {
+        vector<bool> results( queries.size( ) );
+        for( size_t i = 0; i < queries.size( ); i++ )
+            results[ i ] = contains( queries[ i ], count );
+        return results;
+    }
+
+
+/*****************************************************************************
+     PUBLIC PRINT FUNCTIONS
+*****************************************************************************/
+
+    /**
+     * Prints the element with the same key as x
+     */
+    void printNode( const Comparable & x ) const {
+        int count = 0;
+        const Comparable *found = find( x, count );
+        if( found == nullptr )
+            cout << "Element not found in tree." << endl;
+        else
+            cout << *found << endl;
+    }
+
+    /**
+     * Print the tree contents in sorted order.
+     */
+    void printTree( ) const {
+        if( isEmpty( ) )
+            cout << "Empty tree" << endl;
+        else
+            inOrder( [ ]( const Comparable & element ) { cout << element << endl; } );
+    }
+
+    /**
+     * Calls visit( element ) on every element in sorted order, walking the
+     * leaves from the leftmost
+     */
+    template <typename Visitor>
+    void inOrder( Visitor visit ) const {
+        if( isEmpty( ) )
+            return;
+        void *t = root;
+        for( int level = height; level > 1; level-- )
+            t = inner( t )->children[ 0 ];
+        visitFrom( leaf( t ), 0, visit, [ ]( const Comparable & ) { return true; } );
+    }
+
+    /**
+     * Calls visit( element ) on every element from lo to hi inclusive, in
+     * sorted order. Walks down to lo once, then along the leaves.
+     */
+    template <typename Visitor>
+    void range( const Comparable & lo, const Comparable & hi, Visitor visit ) const {
+        if( isEmpty( ) )
+            return;
+        const Key & key = lo.getKey( );
+        uint64_t prefix = key.prefix( );
+        bool equal;
+        void *t = root;
+        for( int level = height; level > 1; level-- ) {
+            InnerNode *n = inner( t );
+            t = n->children[ position( n->prefixes, n->size, prefix, key, keysOf( n ), true, equal ) ];
+        }
+        LeafNode *l = leaf( t );
+        int i = position( l->prefixes, l->size, prefix, key, keysOf( l ), false, equal );
+        visitFrom( l, i, visit, [ &hi ]( const Comparable & element ) { return !( hi < element ); } );
+    }
+
+
+/*****************************************************************************
+     PUBLIC INSERT/REMOVE FUNCTIONS
+*****************************************************************************/
+
+    /**
+     * Make the tree empty and free its nodes.
+     */
+    void makeEmpty( ) {
+        if( root != nullptr )
+            destroy( root, height );
+        leaves.release( );
+        inners.release( );
+        root = nullptr;
+        height = 0;
+        size = 0;
+    }
+
+    /**
+     * Insert x into the tree; duplicates are merged
+     * Counts the nodes visited
+     */
+    void insert( const Comparable & x, int & count ) {
+        add( x, count );
+    }
+
+    void insert( Comparable && x, int & count ) {
+        add( std::move( x ), count );
+    }
+
+    /**
+     * Replace the contents of the tree with the elements in [first, last).
+     * Elements are sorted and duplicates merged, then the leaves are
+     * filled left to right and the inner levels built over them, so no
+     * node is split. Pass move iterators to avoid copying the elements.
+     */
+    template <typename InputIterator>
+    void bulkLoad( InputIterator first, InputIterator last ) {
+        makeEmpty( );
+
+        vector<Comparable> items( first, last );
+        vector<Comparable *> sorted;
+        sorted.reserve( items.size( ) );
+        for( Comparable & item : items )
+            sorted.push_back( &item );
+        auto less = [ ]( const Comparable *a, const Comparable *b ) { return *a < *b; };
+        if( !is_sorted( sorted.begin( ), sorted.end( ), less ) )
+            sort( sorted.begin( ), sorted.end( ), less );
+
+        // Merge runs of duplicates into their first element
+        size_t unique = 0;
+        for( size_t i = 0; i < sorted.size( ); i++ ) {
+            if( unique > 0 && !( *sorted[ unique - 1 ] < *sorted[ i ] ) )
+                sorted[ unique - 1 ]->merge( std::move( *sorted[ i ] ) );
+            else
+                sorted[ unique++ ] = sorted[ i ];
+        }
+        sorted.resize( unique );
+
+        build( sorted );
+    }
+
+    /**
+     * Remove x from the tree. Nothing is done if x is not found.
+     * Counts the nodes visited
+     */
+    bool remove( const Comparable & x, int & count ) {
+        if( isEmpty( ) )
+            return false;
+
+        const Key & key = x.getKey( );
+        uint64_t prefix = key.prefix( );
+        InnerNode *path[ MAX_HEIGHT ];
+        int slots[ MAX_HEIGHT ];
+        LeafNode *l = descend( key, prefix, path, slots, count );
+        bool equal;
+        int i = position( l->prefixes, l->size, prefix, key, keysOf( l ), false, equal );
+        if( !equal )
+            return false;
+
+        l->element( i ).~Comparable( );
+        shiftLeft( l, i + 1 );
+        l->size--;
+        size--;
+        rebalanceLeaf( l, path, slots, height - 1 );
+        return true;
+    }
+
+
+/******************************************************************************
+     PUBLIC SNAPSHOT FUNCTIONS
+******************************************************************************/
+
+    /**
+     * Writes the tree to a snapshot file at path, its elements in sorted
+     * order. Returns false if the file could not be written.
+     */
+    bool save( const string & path, bool /*shape*/ = true ) const {
+        SnapshotWriter writer( false );
+        inOrder( [ &writer ]( const Comparable & element ) { writer.add( element, 0 ); } );
+        return writer.write( path );
+    }
+
+    /**
+     * Replaces the contents of the tree with the snapshot at path. Its
+     * elements are already sorted, so the tree is built as by bulkLoad( )
+     * without comparing keys.
+     * Returns false, leaving the tree unchanged, if path is not a valid
+     * snapshot.
+     */
+    bool load( const string & path ) {
+        SnapshotReader reader( path );
+        if( reader.fail( ) )
+            return false;
+
+        makeEmpty( );
+        vector<Comparable> items;
+        items.reserve( reader.size( ) );
+        for( size_t i = 0; i < reader.size( ); i++ )
+            items.push_back( reader.element( i ) );
+        vector<Comparable *> sorted;
+        sorted.reserve( items.size( ) );
+        for( Comparable & item : items )
+            sorted.push_back( &item );
+        build( sorted );
+        return true;
+    }
+
+
+/******************************************************************************
+    PUBLIC FUNCTIONS TO GET TREE CHARACTERISTICS
+ ******************************************************************************/
+
+    bool isEmpty( ) const {
+        return size == 0;
+    }
+
+    /**
+     * Returns the number of elements in the tree
+     */
+    int nodes( ) const {
+        return size;
+    }
+
+    /**
+     * Returns the number of inner and leaf nodes in the tree
+     */
+    int treeNodes( ) const {
+        return root == nullptr ? 0 : countNodes( root, height );
+    }
+
+    /**
+     * Returns the sum of the depth of the leaf of every element. Every leaf
+     * is at the same depth, one less than the levels of the tree.
+     */
+    int internalPathLength( ) const {
+        return height == 0 ? 0 : size * ( height - 1 );
+    }
+
+    /**
+     * Returns the number of prefix and key comparisons made by insert,
+     * remove and contains since the tree was created
+     */
+    long keyComparisons( ) const {
+        return comparisons;
+    }
+
+
+private:
+
+/*****************************************************************************
+     Member Data
+*****************************************************************************/
+
+    typedef typename decay<decltype( declval<const Comparable &>( ).getKey( ) )>::type Key;
+
+    // Fewest elements in a leaf and keys in an inner node, but for the root
+    static const int MIN_ELEMENTS = FANOUT / 2;
+    static const int MIN_KEYS = ( FANOUT + 1 ) / 2 - 1;
+
+    // Most levels of a tree. Every inner node but the root has at least two
+    // children, so 32 levels hold any tree whose size fits in an int.
+    static const int MAX_HEIGHT = 32;
+
+    struct alignas( 64 ) LeafNode {
+        uint64_t prefixes[ FANOUT ];
+        int size = 0;
+        LeafNode *next = nullptr;
+        // Constructed only below size
+        typename aligned_storage<sizeof( Comparable ), alignof( Comparable )>::type slots[ FANOUT ];
+
+        Comparable & element( int i ) {
+            return *reinterpret_cast<Comparable *>( &slots[ i ] );
+        }
+
+        const Comparable & element( int i ) const {
+            return *reinterpret_cast<const Comparable *>( &slots[ i ] );
+        }
+    };
+
+    // Child i + 1 holds the keys from keys[ i ] up to keys[ i + 1 ]. A node
+    // holds one key and child more than it may keep, while it is split.
+    struct alignas( 64 ) InnerNode {
+        uint64_t prefixes[ FANOUT ];
+        int size = 0;                   // Keys; there is one more child
+        void *children[ FANOUT + 1 ];   // Leaves in the lowest inner level
+        Key keys[ FANOUT ];
+    };
+
+    void *root;
+    int height;                 // Levels, 0 for an empty tree
+    Allocator<LeafNode> leaves;
+    Allocator<InnerNode> inners;
+    int size;                   // Elements held
+    mutable long comparisons;   // Prefix and key comparisons made so far
+
+
+    static InnerNode * inner( void *t ) {
+        return static_cast<InnerNode *>( t );
+    }
+
+    static LeafNode * leaf( void *t ) {
+        return static_cast<LeafNode *>( t );
+    }
+
+    static auto keysOf( const InnerNode *n ) {
+        return [ n ]( int i ) -> const Key & { return n->keys[ i ]; };
+    }
+
+    static auto keysOf( const LeafNode *l ) {
+        return [ l ]( int i ) -> const Key & { return l->element( i ).getKey( ); };
+    }
+
+
+/*****************************************************************************
+     Find Functions
+*****************************************************************************/
+
+    /**
+     * Returns the number of keys in a node that are less than key, or with
+     * upper, no greater than it. The prefixes are binary searched, and only
+     * keys whose prefix equals that of key are compared whole.
+     * Sets equal if the key found there equals key.
+     */
+    template <typename KeyAt>
+    int position( const uint64_t *prefixes, int n, uint64_t prefix, const Key & key, KeyAt keyAt,
+                  bool upper, bool & equal ) const {
+        int lo = 0;
+        int hi = n;
+        while( lo < hi ) {
+            int mid = ( lo + hi ) / 2;
+            comparisons++;
+            if( prefixes[ mid ] < prefix )
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        equal = false;
+        while( lo < n && prefixes[ lo ] == prefix ) {
+            comparisons++;
+            int cmp = keyAt( lo ).compare( key );
+            if( cmp > 0 )
+                break;
+            if( cmp == 0 && !upper ) {
+                equal = true;
+                break;
+            }
+            lo++;
+        }
+        return lo;
+    }
+
+    /**
+     * Returns the element with the same key as x, or nullptr
+     * Counts the nodes visited
+     */
+    const Comparable * find( const Comparable & x, int & count ) const {
+        if( isEmpty( ) )
+            return nullptr;
+
+        const Key & key = x.getKey( );
+        uint64_t prefix = key.prefix( );
+        bool equal;
+        void *t = root;
+        for( int level = height; level > 1; level-- ) {
+            count++;
+            InnerNode *n = inner( t );
+            t = n->children[ position( n->prefixes, n->size, prefix, key, keysOf( n ), true, equal ) ];
+        }
+        count++;
+        LeafNode *l = leaf( t );
+        int i = position( l->prefixes, l->size, prefix, key, keysOf( l ), false, equal );
+        return equal ? &l->element( i ) : nullptr;
+    }
+
+    /**
+     * Walks down to the leaf where key belongs. Records each inner node
+     * passed in path and the child taken in slots.
+     * Counts the nodes visited
+     */
+    LeafNode * descend( const Key & key, uint64_t prefix, InnerNode *path[ ], int slots[ ], int & count ) const {
+        bool equal;
+        void *t = root;
+        for( int depth = 0; depth < height - 1; depth++ ) {
+            count++;
+            InnerNode *n = inner( t );
+            path[ depth ] = n;
+            slots[ depth ] = position( n->prefixes, n->size, prefix, key, keysOf( n ), true, equal );
+            t = n->children[ slots[ depth ] ];
+        }
+        count++;
+        return leaf( t );
+    }
+
+    /**
+     * Calls visit( element ) on the elements from slot i of leaf l onwards,
+     * across the leaves to its right, until one fails more
+     */
+    template <typename Visitor, typename Predicate>
+    static void visitFrom( LeafNode *l, int i, Visitor & visit, Predicate more ) {
+        for( ; l != nullptr; l = l->next, i = 0 ) {
+            for( ; i < l->size; i++ ) {
+                if( !more( l->element( i ) ) )
+                    return;
+                visit( l->element( i ) );
+            }
+        }
+    }
+
+
+/*****************************************************************************
+     Insert Functions
+*****************************************************************************/
+
+    /**
+     * Inserts x, merging it with the element with the same key if there is
+     * one. A full leaf is split first, and the separator that splitting
+     * adds goes up into the inner nodes on the path.
+     * Counts the nodes visited
+     */
+    template <typename Element>
+    void add( Element && x, int & count ) {
+        if( root == nullptr ) {
+            root = leaves.create( );
+            height = 1;
+        }
+
+        const Key & key = x.getKey( );
+        uint64_t prefix = key.prefix( );
+        InnerNode *path[ MAX_HEIGHT ];
+        int slots[ MAX_HEIGHT ];
+        LeafNode *l = descend( key, prefix, path, slots, count );
+        bool equal;
+        int i = position( l->prefixes, l->size, prefix, key, keysOf( l ), false, equal );
+        if( equal ) {
+            l->element( i ).merge( std::forward<Element>( x ) );
+            return;
+        }
+
+        size++;
+        if( l->size < FANOUT ) {
+            put( l, i, std::forward<Element>( x ), prefix );
+            return;
+        }
+
+        // Split the full leaf, then put x in whichever half it belongs to
+        LeafNode *right = leaves.create( );
+        int half = ( FANOUT + 1 ) / 2;
+        for( int j = half; j < FANOUT; j++ )
+            relocate( l, j, right, j - half );
+        right->size = FANOUT - half;
+        l->size = half;
+        right->next = l->next;
+        l->next = right;
+        if( i <= half )
+            put( l, i, std::forward<Element>( x ), prefix );
+        else
+            put( right, i - half, std::forward<Element>( x ), prefix );
+
+        addSeparator( path, slots, height - 1, right->element( 0 ).getKey( ), right->prefixes[ 0 ], right );
+    }
+
+    /**
+     * Puts x into slot i of leaf l, which has room for it
+     */
+    template <typename Element>
+    void put( LeafNode *l, int i, Element && x, uint64_t prefix ) {
+        shiftRight( l, i );
+        new( &l->slots[ i ] ) Comparable( std::forward<Element>( x ) );
+        l->prefixes[ i ] = prefix;
+        l->size++;
+    }
+
+    /**
+     * Adds key, and child to its right, to the inner node at path[ depth - 1 ]
+     * after the child taken on the way down. A node that overflows is split
+     * around its middle key, which goes up to the next node on the path in
+     * turn; a new root is made when the old one splits.
+     */
+    void addSeparator( InnerNode *path[ ], int slots[ ], int depth, Key key, uint64_t prefix, void *child ) {
+        while( depth > 0 ) {
+            InnerNode *n = path[ --depth ];
+            int i = slots[ depth ];
+            for( int j = n->size; j > i; j-- ) {
+                n->keys[ j ] = std::move( n->keys[ j - 1 ] );
+                n->prefixes[ j ] = n->prefixes[ j - 1 ];
+                n->children[ j + 1 ] = n->children[ j ];
+            }
+            n->keys[ i ] = std::move( key );
+            n->prefixes[ i ] = prefix;
+            n->children[ i + 1 ] = child;
+            if( ++n->size < FANOUT )
+                return;
+
+            InnerNode *right = inners.create( );
+            int mid = FANOUT / 2;
+            for( int j = mid + 1; j < FANOUT; j++ ) {
+                right->keys[ j - mid - 1 ] = std::move( n->keys[ j ] );
+                right->prefixes[ j - mid - 1 ] = n->prefixes[ j ];
+                right->children[ j - mid - 1 ] = n->children[ j ];
+            }
+            right->children[ FANOUT - mid - 1 ] = n->children[ FANOUT ];
+            right->size = FANOUT - mid - 1;
+            n->size = mid;
+            key = std::move( n->keys[ mid ] );
+            prefix = n->prefixes[ mid ];
+            child = right;
+        }
+
+        InnerNode *top = inners.create( );
+        top->keys[ 0 ] = std::move( key );
+        top->prefixes[ 0 ] = prefix;
+        top->children[ 0 ] = root;
+        top->children[ 1 ] = child;
+        top->size = 1;
+        root = top;
+        height++;
+    }
+
+    /**
+     * Builds the tree from sorted, unique elements, moving each into a
+     * leaf. The leaves, and then each inner level, are filled as evenly as
+     * they can be with as few nodes as will hold them, so every node is at
+     * least half full.
+     */
+    void build( const vector<Comparable *> & sorted ) {
+        int n = static_cast<int>( sorted.size( ) );
+        if( n == 0 )
+            return;
+
+        vector<void *> level;
+        vector<const Key *> firsts;     // Smallest key under each node of level
+        int count = ( n + FANOUT - 1 ) / FANOUT;
+        LeafNode *previous = nullptr;
+        for( int k = 0, next = 0; k < count; k++ ) {
+            LeafNode *l = leaves.create( );
+            int take = n / count + ( k < n % count );
+            for( int j = 0; j < take; j++, next++ ) {
+                new( &l->slots[ j ] ) Comparable( std::move( *sorted[ next ] ) );
+                l->prefixes[ j ] = l->element( j ).getKey( ).prefix( );
+            }
+            l->size = take;
+            if( previous != nullptr )
+                previous->next = l;
+            previous = l;
+            level.push_back( l );
+            firsts.push_back( &l->element( 0 ).getKey( ) );
+        }
+        height = 1;
+
+        while( level.size( ) > 1 ) {
+            int children = static_cast<int>( level.size( ) );
+            count = ( children + FANOUT - 1 ) / FANOUT;
+            vector<void *> above;
+            vector<const Key *> aboveFirsts;
+            for( int k = 0, next = 0; k < count; k++ ) {
+                InnerNode *t = inners.create( );
+                int take = children / count + ( k < children % count );
+                aboveFirsts.push_back( firsts[ next ] );
+                for( int j = 0; j < take; j++, next++ ) {
+                    t->children[ j ] = level[ next ];
+                    if( j > 0 ) {
+                        t->keys[ j - 1 ] = *firsts[ next ];
+                        t->prefixes[ j - 1 ] = firsts[ next ]->prefix( );
+                    }
+                }
+                t->size = take - 1;
+                above.push_back( t );
+            }
+            level.swap( above );
+            firsts.swap( aboveFirsts );
+            height++;
+        }
+        root = level[ 0 ];
+        size = n;
+    }
+
+
+/*****************************************************************************
+     Remove Functions
+*****************************************************************************/
+
+    /**
+     * Refills leaf l, at depth in the tree, if a remove left it less than
+     * half full: from a sibling with elements to spare, or else by merging
+     * it with a sibling. An empty root leaf is freed.
+     */
+    void rebalanceLeaf( LeafNode *l, InnerNode *path[ ], int slots[ ], int depth ) {
+        if( depth == 0 ) {
+            if( l->size == 0 ) {
+                leaves.destroy( l );
+                root = nullptr;
+                height = 0;
+            }
+            return;
+        }
+        if( l->size >= MIN_ELEMENTS )
+            return;
+
+        InnerNode *parent = path[ depth - 1 ];
+        int i = slots[ depth - 1 ];
+        if( i > 0 ) {
+            LeafNode *left = leaf( parent->children[ i - 1 ] );
+            if( left->size > MIN_ELEMENTS ) {
+                shiftRight( l, 0 );
+                relocate( left, left->size - 1, l, 0 );
+                left->size--;
+                l->size++;
+                parent->keys[ i - 1 ] = l->element( 0 ).getKey( );
+                parent->prefixes[ i - 1 ] = l->prefixes[ 0 ];
+                return;
+            }
+            mergeLeaves( left, l );
+            removeSeparator( path, slots, depth - 1, i - 1 );
+        }
+        else {
+            LeafNode *right = leaf( parent->children[ i + 1 ] );
+            if( right->size > MIN_ELEMENTS ) {
+                relocate( right, 0, l, l->size );
+                shiftLeft( right, 1 );
+                right->size--;
+                l->size++;
+                parent->keys[ i ] = right->element( 0 ).getKey( );
+                parent->prefixes[ i ] = right->prefixes[ 0 ];
+                return;
+            }
+            mergeLeaves( l, right );
+            removeSeparator( path, slots, depth - 1, i );
+        }
+    }
+
+    /**
+     * Moves every element of right to the end of left, its sibling, and
+     * frees right
+     */
+    void mergeLeaves( LeafNode *left, LeafNode *right ) {
+        for( int j = 0; j < right->size; j++ )
+            relocate( right, j, left, left->size + j );
+        left->size += right->size;
+        left->next = right->next;
+        leaves.destroy( right );
+    }
+
+    /**
+     * Removes key i, and the child to its right, from the inner node at
+     * path[ depth ], then refills that node as rebalanceLeaf( ) does a
+     * leaf. Merging two nodes brings their separator down between them and
+     * removes it from the node above in turn. A root left with one child
+     * is replaced by it.
+     */
+    void removeSeparator( InnerNode *path[ ], int slots[ ], int depth, int i ) {
+        while( true ) {
+            InnerNode *n = path[ depth ];
+            for( int j = i; j < n->size - 1; j++ ) {
+                n->keys[ j ] = std::move( n->keys[ j + 1 ] );
+                n->prefixes[ j ] = n->prefixes[ j + 1 ];
+                n->children[ j + 1 ] = n->children[ j + 2 ];
+            }
+            n->size--;
+
+            if( depth == 0 ) {
+                if( n->size == 0 ) {
+                    root = n->children[ 0 ];
+                    inners.destroy( n );
+                    height--;
+                }
+                return;
+            }
+            if( n->size >= MIN_KEYS )
+                return;
+
+            InnerNode *parent = path[ depth - 1 ];
+            int k = slots[ depth - 1 ];
+            if( k > 0 ) {
+                InnerNode *left = inner( parent->children[ k - 1 ] );
+                if( left->size > MIN_KEYS ) {
+                    for( int j = n->size; j > 0; j-- ) {
+                        n->keys[ j ] = std::move( n->keys[ j - 1 ] );
+                        n->prefixes[ j ] = n->prefixes[ j - 1 ];
+                        n->children[ j + 1 ] = n->children[ j ];
+                    }
+                    n->children[ 1 ] = n->children[ 0 ];
+                    n->keys[ 0 ] = std::move( parent->keys[ k - 1 ] );
+                    n->prefixes[ 0 ] = parent->prefixes[ k - 1 ];
+                    n->children[ 0 ] = left->children[ left->size ];
+                    parent->keys[ k - 1 ] = std::move( left->keys[ left->size - 1 ] );
+                    parent->prefixes[ k - 1 ] = left->prefixes[ left->size - 1 ];
+                    left->size--;
+                    n->size++;
+                    return;
+                }
+                mergeInner( left, n, parent, k - 1 );
+                i = k - 1;
+            }
+            else {
+                InnerNode *right = inner( parent->children[ k + 1 ] );
+                if( right->size > MIN_KEYS ) {
+                    n->keys[ n->size ] = std::move( parent->keys[ k ] );
+                    n->prefixes[ n->size ] = parent->prefixes[ k ];
+                    n->children[ n->size + 1 ] = right->children[ 0 ];
+                    parent->keys[ k ] = std::move( right->keys[ 0 ] );
+                    parent->prefixes[ k ] = right->prefixes[ 0 ];
+                    for( int j = 0; j < right->size - 1; j++ ) {
+                        right->keys[ j ] = std::move( right->keys[ j + 1 ] );
+                        right->prefixes[ j ] = right->prefixes[ j + 1 ];
+                        right->children[ j ] = right->children[ j + 1 ];
+                    }
+                    right->children[ right->size - 1 ] = right->children[ right->size ];
+                    right->size--;
+                    n->size++;
+                    return;
+                }
+                mergeInner( n, right, parent, k );
+                i = k;
+            }
+            depth--;
+        }
+    }
+
+    /**
+     * Appends separator i of parent and then every key and child of right
+     * to left, its sibling, and frees right. The caller removes the
+     * separator from parent.
+     */
+    void mergeInner( InnerNode *left, InnerNode *right, InnerNode *parent, int i ) {
+        left->keys[ left->size ] = std::move( parent->keys[ i ] );
+        left->prefixes[ left->size ] = parent->prefixes[ i ];
+        for( int j = 0; j < right->size; j++ ) {
+            left->keys[ left->size + 1 + j ] = std::move( right->keys[ j ] );
+            left->prefixes[ left->size + 1 + j ] = right->prefixes[ j ];
+        }
+        for( int j = 0; j <= right->size; j++ )
+            left->children[ left->size + 1 + j ] = right->children[ j ];
+        left->size += 1 + right->size;
+        inners.destroy( right );
+    }
+
+
+/*****************************************************************************
+     Element Moving Functions
+*****************************************************************************/
+
+    /**
+     * Moves the element in slot i of from into the empty slot j of to
+     */
+    static void relocate( LeafNode *from, int i, LeafNode *to, int j ) {
+        new( &to->slots[ j ] ) Comparable( std::move( from->element( i ) ) );
+        from->element( i ).~Comparable( );
+        to->prefixes[ j ] = from->prefixes[ i ];
+    }
+
+    /**
+     * Moves the elements of l from slot i on up one slot, leaving slot i
+     * empty. Does not change the size.
+     */
+    static void shiftRight( LeafNode *l, int i ) {
+        for( int j = l->size - 1; j >= i; j-- )
+            relocate( l, j, l, j + 1 );
+    }
+
+    /**
+     * Moves the elements of l from slot i on down one slot, into the empty
+     * slot i - 1. Does not change the size.
+     */
+    static void shiftLeft( LeafNode *l, int i ) {
+        for( int j = i; j < l->size; j++ )
+            relocate( l, j, l, j - 1 );
+    }
+
+
+/*****************************************************************************
+     Functions to calculate characteristics of tree
+*****************************************************************************/
+
+    /**
+     * Counts the nodes under t, whose subtree has levels levels
+     */
+    int countNodes( void *t, int levels ) const {
+        if( levels == 1 )
+            return 1;
+        int n = 1;
+        for( int i = 0; i <= inner( t )->size; i++ )
+            n += countNodes( inner( t )->children[ i ], levels - 1 );
+        return n;
+    }
+
+    /**
+     * Destroys the elements and nodes under t, whose subtree has levels
+     * levels
+     */
+    void destroy( void *t, int levels ) {
+        if( levels == 1 ) {
+            LeafNode *l = leaf( t );
+            for( int i = 0; i < l->size; i++ )
+                l->element( i ).~Comparable( );
+            leaves.destroy( l );
+            return;
+        }
+        InnerNode *n = inner( t );
+        for( int i = 0; i <= n->size; i++ )
+            destroy( n->children[ i ], levels - 1 );
+        inners.destroy( n );
+    }
+};
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef BATCH_QUERY_H
+#define BATCH_QUERY_H
+
+/*****************************************************************************
+ Title:             BatchQuery.h
+ Created on:        October 18, 2026
+ Description:       Helpers for answering a batch of queries in key order,
+                    as the binary trees' findBatch( ) does.
+
+                    keyPrefix(x):
+                    Returns x.getKey().prefix() when Comparable has one, a
+                    word that orders keys by their first symbols (see
+                    PackedSequence::prefix()), else 0. Keys whose prefixes
+                    differ are ordered by them; equal prefixes say nothing.
+
+                    BatchQuery:
+                    The prefix of a query's key and its index in the batch.
+
+                    sortBatch(order, less):
+                    Sorts order as less does. The queries are radix sorted
+                    by prefix, a byte at a time, skipping the bytes every
+                    prefix shares, and only runs of equal prefixes are
+                    sorted with less. Sorting the prefixes costs a few
+                    passes over order, where a comparison sort would read
+                    the keys of the queries about log2( n ) times each.
+
+ ****************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+template <typename Comparable>
+auto keyPrefix( const Comparable & x, int ) -> decltype( uint64_t( x.getKey( ).prefix( ) ) ) {
+    return x.getKey( ).prefix( );
+}
+
+template <typename Comparable>
+uint64_t keyPrefix( const Comparable &, long ) {
+    return 0;
+}
+
+template <typename Comparable>
+uint64_t keyPrefix( const Comparable & x ) {
+    // The literal 0 prefers the getKey( ).prefix( ) overload when it exists
+    return keyPrefix( x, 0 );
+}
+
+struct BatchQuery {
+    uint64_t prefix;
+    size_t index;
+};
+
+/**
+ * Sorts order by prefix, then each run of equal prefixes with less, which
+ * must order queries with different prefixes by prefix.
+ */
+template <typename Less>
+void sortBatch( vector<BatchQuery> & order, Less less ) {
+    if ( order.size( ) < 2 )
+        return;
+
+    // Bytes that differ between some two prefixes
+    uint64_t differ = 0;
+    for ( const BatchQuery & q : order )
+        differ |= q.prefix ^ order[ 0 ].prefix;
+
+    // Least significant byte first, so each pass keeps the order of the last
+    vector<BatchQuery> buffer( order.size( ) );
+    for ( int shift = 0; shift < 64; shift += 8 ) {
+        if ( ( ( differ >> shift ) & 0xFF ) == 0 )
+            continue;
+        size_t start[ 257 ] = { 0 };
+        for ( const BatchQuery & q : order )
+            start[ ( ( q.prefix >> shift ) & 0xFF ) + 1 ]++;
+        for ( int b = 0; b < 256; b++ )
+            start[ b + 1 ] += start[ b ];
+        for ( const BatchQuery & q : order )
+            buffer[ start[ ( q.prefix >> shift ) & 0xFF ]++ ] = q;
+        order.swap( buffer );
+    }
+
+    for ( size_t lo = 0; lo < order.size( ); ) {
+        size_t hi = lo + 1;
+        while ( hi < order.size( ) && order[ hi ].prefix == order[ lo ].prefix )
+            hi++;
+        if ( hi - lo > 1 )
+            sort( order.begin( ) + lo, order.begin( ) + hi, less );
+        lo = hi;
+    }
+}
+
+#endif
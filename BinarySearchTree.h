@@ -15,13 +15,22 @@
  
  ****************************************************************************/
 
+#include "BatchQuery.h"
 #include "dsexceptions.h"
+#include "NodePool.h"
+#include "ThreeWayCompare.h"
+#include "TreeIterator.h"
+#include "TreeSnapshot.h"
 #include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
 using namespace std;
 
 // BinarySearchTree class
 //
-// CONSTRUCTION: zero parameter
+// CONSTRUCTION: zero parameter. Nodes come from Allocator, a NodePool by
+//               default (see NodePool.h).
 //
 // ******************PUBLIC OPERATIONS*********************
 // void insert( x, count )     --> Insert x. Adds to count the number of
@@ -31,39 +40,69 @@ using namespace std;
 // bool contains( x, count )   --> Return true if x is present; else false.
 //                                 Adds to count the number of recursive calls
 //                                 made.
+// vector<bool> containsBatch( xs, count )
+//                             --> Result i is true if xs[i] is present.
+//                                 Answers all of xs in one walk of the
+//                                 tree. Adds to count the nodes visited.
+// findBatch( xs, count )      --> As containsBatch, but result i points to
+//                                 the element equal to xs[i], or is nullptr.
 // Comparable findMin( )       --> Return smallest item
 // Comparable findMax( )       --> Return largest item
 // boolean isEmpty( )          --> Return true if empty; else false
 // void makeEmpty( )           --> Remove all items
 // void printTree( )           --> Print tree in sorted order
 // void printNode(x)           --> Prints element in node containing x
+// void inOrder( visit )       --> Calls visit( element ) on every element
+//                                 in sorted order
+// const_iterator begin( )     --> Iterator to the smallest element
+// const_iterator end( )       --> Iterator past the largest element
+// const_iterator lowerBound( x )
+//                             --> Iterator to the first element not
+//                                 less than x, or end( )
+// const_iterator upperBound( x )
+//                             --> Iterator to the first element
+//                                 greater than x, or end( )
+// range( lo, hi )             --> The elements from lo to hi
+//                                 inclusive, in sorted order
+// prefix( p )                 --> The elements whose key starts with
+//                                 the key of p, in sorted order
 // int nodes( )                --> Returns the number of nodes in the tree
 // int internalPathLength( )   --> Returns the sum of the depth of all nodes
 //                                 in the tree.
+// long keyComparisons( )      --> Returns the number of key comparisons made
+//                                 by insert, remove, contains and find.
+// bool save( path, shape )    --> Writes the tree to a snapshot file (see
+//                                 TreeSnapshot.h), with its shape unless
+//                                 shape is false. Returns false on failure.
+// bool load( path )           --> Replaces the contents with a snapshot.
+//                                 Returns false, leaving the tree as it
+//                                 was, if the file is not a valid snapshot.
 // ******************ERRORS********************************
 // Throws UnderflowException as warranted
 
-template <typename Comparable>
+template <typename Comparable, template <typename> class Allocator = NodePool>
 class BinarySearchTree
 {
+    struct BinaryNode;
+
 public:
     
 /******************************************************************************
      PUBLIC CONSTRUCTORS, DESTRUCTORS, MOVERS
 ******************************************************************************/
-    BinarySearchTree( ) : root{ nullptr } { }
+    BinarySearchTree( ) : root{ nullptr }, comparisons{ 0 } { }
     
     /**
      * Copy constructor
      */
-    BinarySearchTree( const BinarySearchTree & rhs ) : root{ nullptr } {
+    BinarySearchTree( const BinarySearchTree & rhs ) : root{ nullptr }, comparisons{ 0 } {
         root = clone( rhs.root );
     }
     
     /**
      * Move constructor
      */
-    BinarySearchTree( BinarySearchTree && rhs ) : root{ rhs.root } {
+    BinarySearchTree( BinarySearchTree && rhs ) : root{ rhs.root }, pool{ std::move( rhs.pool ) }, comparisons{ rhs.comparisons } {
         rhs.root = nullptr;
     }
     
@@ -88,6 +127,8 @@ public:
      */
     BinarySearchTree & operator=( BinarySearchTree && rhs ) {
         std::swap( root, rhs.root );
+        std::swap( pool, rhs.pool );
+        std::swap( comparisons, rhs.comparisons );
         return *this;
     }
     
@@ -123,6 +164,108 @@ public:
         return contains( x, root, count );
     }
     
+    /**
+     * Returns, for each query, a pointer to the element equal to it or
+     * nullptr if there is none. Queries are taken BATCH_WINDOW at a time,
+     * small enough to sort in cache; each window is sorted and answered in
+     * one walk down the tree, visiting each node at most once. Queries are
+     * ordered by the prefixes of their keys (see keyPrefix( )), so whole
+     * keys are only compared where the prefixes are equal, and a window
+     * that is already sorted is not sorted again (see sortBatch( )).
+     * Sorting costs about as much as the searches it saves while the tree
+     * fits in the cache, so for SequenceMap this is no faster than one
+     * contains( ) per query up to about 1000 nodes, and 1.3 to 1.7 times
+     * faster from about 30k nodes.
+     * Counts the number of nodes visited
+     */
+    vector<const Comparable *> findBatch( const vector<Comparable> & queries, int & count ) const {
+        vector<const Comparable *> results( queries.size( ), nullptr );
+        if ( root == nullptr )
+            return results;
+        
+        vector<BatchQuery> order;
+        auto less = [ this, &queries ]( const BatchQuery & a, const BatchQuery & b ) {
+            return compare( queries[ a.index ], a.prefix, queries[ b.index ], b.prefix ) < 0;
+        };
+        for ( size_t start = 0; start < queries.size( ); start += BATCH_WINDOW ) {
+            order.resize( min( BATCH_WINDOW, queries.size( ) - start ) );
+            for ( size_t i = 0; i < order.size( ); i++ )
+                order[ i ] = { keyPrefix( queries[ start + i ] ), start + i };
+            if ( !is_sorted( order.begin( ), order.end( ), less ) )
+                sortBatch( order, less );
+            findBatch( queries, order, results, count );
+        }
+        return results;
+    }
+    
+    /**
+     * Returns, for each query, true if it is found in the tree
+     * Counts the number of nodes visited
+     */
+    vector<bool> containsBatch( const vector<Comparable> & queries, int & count ) const {
+        vector<const Comparable *> found = findBatch( queries, count );
+        vector<bool> results( found.size( ) );
+        for ( size_t i = 0; i < found.size( ); i++ )
+            results[ i ] = found[ i ] != nullptr;
+        return results;
+    }
+    
+    
+/******************************************************************************
+     PUBLIC ITERATOR FUNCTIONS
+******************************************************************************/
+    
+    typedef TreeIterator<BinaryNode, Comparable> const_iterator;
+    
+    /**
+     * Returns an iterator to the smallest element, walking the tree in
+     * sorted order
+     */
+    const_iterator begin( ) const {
+        return const_iterator( root, [ ]( const Comparable & ) { return true; } );
+    }
+    
+    const_iterator end( ) const {
+        return const_iterator( );
+    }
+    
+    /**
+     * Returns an iterator to the first element not less than x
+     */
+    const_iterator lowerBound( const Comparable & x ) const {
+        return const_iterator( root, [ &x ]( const Comparable & element ) { return !( element < x ); } );
+    }
+    
+    /**
+     * Returns an iterator to the first element greater than x
+     */
+    const_iterator upperBound( const Comparable & x ) const {
+        return const_iterator( root, [ &x ]( const Comparable & element ) { return x < element; } );
+    }
+    
+    /**
+     * Returns the elements from lo to hi inclusive, in sorted order.
+     * Finding the ends costs two walks down the tree; the elements are
+     * not copied. The range is empty if hi is less than lo.
+     */
+    TreeRange<const_iterator> range( const Comparable & lo, const Comparable & hi ) const {
+        if( hi < lo )
+            return TreeRange<const_iterator>( end( ), end( ) );
+        return TreeRange<const_iterator>( lowerBound( lo ), upperBound( hi ) );
+    }
+    
+    /**
+     * Returns the elements whose key starts with the key of p, in sorted
+     * order. They follow one another from lowerBound( p ), up to the first
+     * element past p that does not start with it.
+     * Comparable must have startsWith( p ), as SequenceMap does.
+     */
+    TreeRange<const_iterator> prefix( const Comparable & p ) const {
+        const_iterator last( root, [ &p ]( const Comparable & element ) {
+            return p < element && !element.startsWith( p );
+        } );
+        return TreeRange<const_iterator>( lowerBound( p ), last );
+    }
     
 /******************************************************************************
      PUBLIC PRINT FUNCTIONS
@@ -151,15 +294,29 @@ public:
             printTree( root, out );
     }
     
+    /**
+     * Calls visit( element ) on every element in sorted order
+     */
+    template <typename Visitor>
+    void inOrder( Visitor visit ) const {
+        inOrder( root, visit );
+    }
+    
 /******************************************************************************
      PUBLIC INSERT/REMOVE FUNCTIONS
 ******************************************************************************/
    
     /**
      * Make the tree logically empty.
+     * A pooled allocator frees its chunks in one go, so the node walk is
+     * only needed to run element destructors or for per-node allocators.
      */
     void makeEmpty( ) {
-        makeEmpty( root );
+        if( Allocator<BinaryNode>::bulk_release && is_trivially_destructible<Comparable>::value )
+            root = nullptr;
+        else
+            makeEmpty( root );
+        pool.release( );
     }
     
     /**
@@ -170,8 +327,8 @@ public:
         insert(x, root, count);
     }
 
-    void insert ( Comparable &x, int &count ) {
-        insert( std::move( x ), root, count);
+    void insert( Comparable && x, int &count ) {
+        insert( std::move( x ), root, count );
     }
     
     /**
@@ -183,6 +340,44 @@ public:
     }
 
     
+/******************************************************************************
+     PUBLIC SNAPSHOT FUNCTIONS
+******************************************************************************/
+    
+    /**
+     * Writes the tree to a snapshot file at path: its elements in sorted
+     * order and, if shape is true, the depth of each so load( ) rebuilds
+     * this exact tree. Returns false if the file could not be written.
+     */
+    bool save( const string & path, bool shape = true ) const {
+        SnapshotWriter writer( shape );
+        inOrderWithDepth( root, [ &writer ]( BinaryNode *t, uint32_t depth ) {
+            writer.add( t->element, depth );
+        } );
+        return writer.write( path );
+    }
+    
+    /**
+     * Replaces the contents of the tree with the snapshot at path. Nodes
+     * are created in sorted order and linked by depth, so no keys are
+     * compared. A snapshot without a shape gives a balanced tree.
+     * Returns false, leaving the tree unchanged, if path is not a valid
+     * snapshot.
+     */
+    bool load( const string & path ) {
+        SnapshotReader reader( path );
+        if ( reader.fail( ) )
+            return false;
+        
+        makeEmpty( );
+        vector<BinaryNode *> nodes;
+        nodes.reserve( reader.size( ) );
+        for ( size_t i = 0; i < reader.size( ); i++ )
+            nodes.push_back( pool.create( reader.element( i ), nullptr, nullptr ) );
+        root = linkByDepth( nodes, reader.depths( ), [ ]( BinaryNode * ) { } );
+        return true;
+    }
+    
 /******************************************************************************
      PUBLIC FUNCTIONS TO GET TREE CHARACTERISTICS
 ******************************************************************************/
@@ -208,8 +403,15 @@ public:
      * tree
      */
     int internalPathLength() {
-        int start = 0;
-        return totalDepth(root, start);
+        return totalDepth(root);
+    }
+    
+    /**
+     * Returns the number of key comparisons made by insert, remove,
+     * contains and find since the tree was created
+     */
+    long keyComparisons( ) const {
+        return comparisons;
     }
     
 private:
@@ -230,12 +432,53 @@ private:
         : element{ std::move( theElement ) }, left{ lt }, right{ rt } { }
     };
     
+    // Queries sorted and answered together by findBatch( )
+    static constexpr size_t BATCH_WINDOW = 65536;
+
     BinaryNode *root;
+    Allocator<BinaryNode> pool;
+    mutable long comparisons;   // Key comparisons made so far
     
     
+    /**
+     * Three-way compares x with y and counts the key comparisons made.
+     * Returns <0 if x belongs left of y, >0 if right and 0 if equal.
+     */
+    int compare( const Comparable & x, const Comparable & y ) const {
+        return threeWayCompare( x, y, comparisons );
+    }
+
+    /**
+     * As compare( x, y ), given the prefixes of their keys. Only compares
+     * the keys, and counts a key comparison, if the prefixes are equal.
+     */
+    int compare( const Comparable & x, uint64_t xPrefix, const Comparable & y, uint64_t yPrefix ) const {
+        if ( xPrefix != yPrefix )
+            return xPrefix < yPrefix ? -1 : 1;
+        return compare( x, y );
+    }
+
 /******************************************************************************
      Insert Functions
 ******************************************************************************/
+    /**
+     * Internal method to walk down the subtree rooted at t towards x.
+     * Returns the link that holds x, or the empty link where x belongs.
+     * Counts one recursive call per level descended, as the recursive
+     * versions of insert and remove did.
+     */
+    BinaryNode ** descend( const Comparable & x, BinaryNode * & t, int &count ) {
+        BinaryNode **link = &t;
+        while( *link != nullptr ) {
+            int cmp = compare( x, ( *link )->element );
+            if( cmp == 0 )
+                break;
+            count ++;
+            link = ( cmp < 0 ) ? &( *link )->left : &( *link )->right;
+        }
+        return link;
+    }
+    
     /**
      * Internal method to insert into a subtree.
      * x is the item to insert.
@@ -244,36 +487,22 @@ private:
      * Counts the number of recursive calls made to insert
      */
     void insert( const Comparable & x, BinaryNode * & t, int &count) {
-        if( t == nullptr ){
-            t = new BinaryNode{ x, nullptr, nullptr };
-        }
-        else if( t->element > x ){
-            count ++;
-            insert( x, t->left, count);
-        }
-        else if( t->element < x ){
-            count ++;
-            insert( x, t->right, count );
+        BinaryNode **link = descend( x, t, count );
+        if( *link == nullptr ){
+            *link = pool.create( x, nullptr, nullptr );
         }
         else {
-            t->element.merge(x);
+            ( *link )->element.merge(x);
         }
     }
 
     void insert( Comparable && x, BinaryNode * & t, int &count) {
-        if( t == nullptr ){
-            t = new BinaryNode{ std::move( x ), nullptr, nullptr };
-        }
-        else if( t->element > x ){
-            count ++;
-            insert( std::move( x ), t->left, count);
-        }
-        else if( t->element < x ){
-            count ++;
-            insert( std::move( x ), t->right, count);
+        BinaryNode **link = descend( x, t, count );
+        if( *link == nullptr ){
+            *link = pool.create( std::move( x ), nullptr, nullptr );
         }
         else{
-            t->element.merge(x);
+            ( *link )->element.merge( std::move( x ) );
         }
     }
     
@@ -288,57 +517,47 @@ private:
      * Set the new root of the subtree.
      * Counts the number of recursive calls made to remove
      */
-     bool remove( const Comparable & x, BinaryNode * & t, int & count) {
-        if( t == nullptr )
+    bool remove( const Comparable & x, BinaryNode * & t, int & count) {
+        BinaryNode **link = descend( x, t, count );
+        if( *link == nullptr )
             return false; // Item not found; return false
-        if( t->element > x ){
-            count ++;
-            return remove( x, t->left, count);
-        }
-        else if( t->element < x )
-        {
-            count ++;
-            return remove( x, t->right, count);
-        }
-        else if( t->left != nullptr && t->right != nullptr ) // Two children
-        {
-            count ++;
-            t->element = findMin( t->right, count )->element;
-            count ++;
-            return remove( t->element, t->right, count);
-        }
-        else
+        
+        BinaryNode *node = *link;
+        if( node->left != nullptr && node->right != nullptr ) // Two children
         {
-            BinaryNode *oldNode = t;
-            t = ( t->left != nullptr ) ? t->left : t->right;
-            delete oldNode;
-            return true;
+            // Take the smallest item in the right subtree, then unlink its
+            // node. The recursive version counted the walk down to it
+            // twice, once in findMin and once in the remove that followed,
+            // plus one call for each.
+            link = &node->right;
+            int steps = 0;
+            while( ( *link )->left != nullptr ) {
+                link = &( *link )->left;
+                steps ++;
+            }
+            count += 2 + 2 * steps;
+            node->element = std::move( ( *link )->element );
         }
+        
+        BinaryNode *oldNode = *link;
+        *link = ( oldNode->left != nullptr ) ? oldNode->left : oldNode->right;
+        pool.destroy( oldNode );
+        return true;
     }
     
 /******************************************************************************
      Find Functions
 ******************************************************************************/
     
-    /**
-     * Internal method to find the smallest item in a subtree t.
+     /**
+     * Internal methods to find the smallest item in a subtree t.
      * Return node containing the smallest item.
      */
-    BinaryNode * findMin( BinaryNode *t) const {
-        if( t == nullptr )
-            return nullptr;
-        if( t->left == nullptr )
-            return t;
-        return findMin( t->left);
-    }
-    
-    BinaryNode * findMin( BinaryNode *t, int &count ) const {
-        if( t == nullptr )
-            return nullptr;
-        if( t->left == nullptr )
-            return t;
-        count ++;
-        return findMin( t->left, count);
+    BinaryNode * findMin( BinaryNode *t ) const {
+        if( t != nullptr )
+            while( t->left != nullptr )
+                t = t->left;
+        return t;
     }
     
     /**
@@ -357,94 +576,137 @@ private:
      * subtree rooted at t
      * x is the item to find.
      * t is the node that roots the subtree.
-     * Set the new root of the subtree.
      * Returns a pointer to the node containing the element
      * If tree does not contain element, returns nullptr
      */
-    BinaryNode* find( const Comparable & x, BinaryNode *t ) const {
-        
-        if( t == nullptr ) // Item not found
-            return nullptr;
-        else if( t->element > x ){
-            return find( x, t->left );
-        }
-        else if( t->element < x ){
-            return find( x, t->right );
+    BinaryNode * find ( const Comparable & x, BinaryNode *t ) const {
+        while( t != nullptr ) {
+            int cmp = compare( x, t->element );
+            if( cmp == 0 )
+                return t;    // Match. Return pointer to node.
+            t = ( cmp < 0 ) ? t->left : t->right;
         }
-        else
-            return t;    // Match
+        return nullptr;
     }
-    
+
     /**
      * Internal method to test if an item is in a subtree.
      * x is item to search for.
-     * t is the node that roots the subtree.
-     * Returns true if item is in subtree; else returns false
-     * Counts number of recursive calls made to contains
+     * t is the node that roots the tree.
+     * Counts one recursive call per level descended, as the recursive
+     * version did.
      */
     bool contains( const Comparable & x, BinaryNode *t, int &count ) const {
-        if( t == nullptr )
-            return false;
-        else if( t->element > x ){
+        while( t != nullptr ) {
+            int cmp = compare( x, t->element );
+            if( cmp == 0 )
+                return true;    // Match
             count++;
-            return contains( x, t->left, count );
+            t = ( cmp < 0 ) ? t->left : t->right;
         }
-        else if( t->element < x ){
-            count ++;
-            return contains( x, t->right, count );
+        return false;   // No match
+    }
+    
+    /**
+     * Internal method to answer a batch of queries.
+     * order lists the queries, with their prefixes, in sorted order. Each subtree is
+     * handed the run of order that can only be found inside it: the run is
+     * split at the node with one binary search, so queries sharing a path
+     * share the comparisons made along it.
+     * Counts the number of nodes visited.
+     */
+    void findBatch( const vector<Comparable> & queries, const vector<BatchQuery> & order,
+                    vector<const Comparable *> & results, int & count ) const {
+        struct Run {
+            BinaryNode *t;
+            size_t lo, hi;   // order[ lo .. hi ) belongs to subtree t
+        };
+        vector<Run> stack;
+        stack.push_back( { root, 0, order.size( ) } );
+        
+        while ( !stack.empty( ) ) {
+            Run run = stack.back( );
+            stack.pop_back( );
+            BinaryNode *t = run.t;
+            if ( t == nullptr || run.lo == run.hi )
+                continue;
+            count++;
+            uint64_t prefix = keyPrefix( t->element );
+            
+            // First query in the run not less than t's element
+            size_t lo = run.lo, hi = run.hi;
+            while ( lo < hi ) {
+                size_t mid = lo + ( hi - lo ) / 2;
+                if ( compare( queries[ order[ mid ].index ], order[ mid ].prefix, t->element, prefix ) < 0 )
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            
+            // Queries equal to t's element
+            size_t end = lo;
+            while ( end < run.hi &&
+                    compare( queries[ order[ end ].index ], order[ end ].prefix, t->element, prefix ) == 0 ) {
+                results[ order[ end ].index ] = &t->element;
+                end++;
+            }
+            
+            stack.push_back( { t->left, run.lo, lo } );
+            stack.push_back( { t->right, end, run.hi } );
         }
-        else
-            return true;    // Match
-    }
-    /****** NONRECURSIVE VERSION*************************
-     bool contains( const Comparable & x, BinaryNode *t ) const
-     {
-     while( t != nullptr )
-     if( x < t->element )
-     t = t->left;
-     else if( t->element < x )
-     t = t->right;
-     else
-     return true;    // Match
-     
-     return false;   // No match
-     }
-     *****************************************************/
-
+    }
+    
     
 /******************************************************************************
      Functions to calculate characteristics of tree
 ******************************************************************************/
     
     /**
-     * Recursively counts number of nodes in tree rooted at t
+     * Counts number of nodes in tree rooted at t, using an explicit stack
      */
     int countNodes ( BinaryNode *t ) const {
-        if (t == nullptr) {
-            return 0;
-        }
-        if (t->left == nullptr && t->right == nullptr) {
-            return 1;
+        int n = 0;
+        vector<BinaryNode *> stack;
+        if (t != nullptr) {
+            stack.push_back(t);
         }
-        else {
-            return 1 + countNodes(t->left) + countNodes(t->right);
+        while (!stack.empty()) {
+            BinaryNode *node = stack.back();
+            stack.pop_back();
+            n++;
+            if (node->left != nullptr) {
+                stack.push_back(node->left);
+            }
+            if (node->right != nullptr) {
+                stack.push_back(node->right);
+            }
         }
+        return n;
     }
-
     
     /**
-     * Returns sum of the depth of all nodes in tree rooted at t
+     * Returns sum of the depth of all nodes in tree rooted at t, using an
+     * explicit stack. The root has depth 0.
      */
-    int totalDepth( BinaryNode *t, int& totald) {
-        
-        if (t == nullptr) {
-            return totald-1;
+    int totalDepth( BinaryNode *t ) const {
+        int total = 0;
+        vector<pair<BinaryNode *, int>> stack;
+        if (t != nullptr) {
+            stack.push_back(make_pair(t, 0));
         }
-        else {
-            totald++;
-            return totalDepth(t->left, totald) + totalDepth(t->right, totald);
+        while (!stack.empty()) {
+            BinaryNode *node = stack.back().first;
+            int depth = stack.back().second;
+            stack.pop_back();
+            total += depth;
+            if (node->left != nullptr) {
+                stack.push_back(make_pair(node->left, depth + 1));
+            }
+            if (node->right != nullptr) {
+                stack.push_back(make_pair(node->right, depth + 1));
+            }
         }
-        
+        return total;
     }
 
 /******************************************************************************
@@ -463,31 +725,64 @@ private:
         }
     }
     
+    /**
+     * Internal method to visit a subtree rooted at t in sorted order.
+     */
+    template <typename Visitor>
+    void inOrder( BinaryNode *t, Visitor & visit ) const {
+        if( t != nullptr )
+        {
+            inOrder( t->left, visit );
+            visit( t->element );
+            inOrder( t->right, visit );
+        }
+    }
+    
 /******************************************************************************
      Internal Constructor/Destructor Helper Functions
 ******************************************************************************/
     
     /**
      * Internal method to make subtree empty.
+     * Rotates left children up until the node has none, then frees it and
+     * moves to its right child, so no stack is needed.
      */
     void makeEmpty( BinaryNode * & t ) {
-        if( t != nullptr )
+        while( t != nullptr )
         {
-            makeEmpty( t->left );
-            makeEmpty( t->right );
-            delete t;
+            if( t->left != nullptr ) {
+                BinaryNode *lt = t->left;
+                t->left = lt->right;
+                lt->right = t;
+                t = lt;
+            }
+            else {
+                BinaryNode *rt = t->right;
+                pool.destroy( t );
+                t = rt;
+            }
         }
-        t = nullptr;
     }
-
+    
     /**
-     * Internal method to clone subtree.
+     * Internal method to clone subtree, using an explicit stack of nodes
+     * still to copy and the links their copies go in.
      */
-    BinaryNode * clone( BinaryNode *t ) const {
-        if( t == nullptr )
-            return nullptr;
-        else
-            return new BinaryNode{ t->element, clone( t->left ), clone( t->right ) };
+    BinaryNode * clone( BinaryNode *t ) {
+        BinaryNode *copy = nullptr;
+        vector<pair<BinaryNode *, BinaryNode **>> stack;
+        stack.push_back( make_pair( t, &copy ) );
+        while( !stack.empty( ) ) {
+            BinaryNode *src = stack.back( ).first;
+            BinaryNode **link = stack.back( ).second;
+            stack.pop_back( );
+            if( src != nullptr ) {
+                *link = pool.create( src->element, nullptr, nullptr );
+                stack.push_back( make_pair( src->right, &( *link )->right ) );
+                stack.push_back( make_pair( src->left, &( *link )->left ) );
+            }
+        }
+        return copy;
     }
 };
 
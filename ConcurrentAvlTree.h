@@ -0,0 +1,446 @@
+#ifndef CONCURRENT_AVL_TREE_H
+#define CONCURRENT_AVL_TREE_H
+
+/*****************************************************************************
+ Title:             ConcurrentAvlTree.h
+ Created on:        October 18, 2026
+ Description:       Template class for an AVL tree that many threads can
+                    read while one thread at a time writes.
+
+                    Nodes are never changed once a reader can see them. A
+                    writer copies the path from the root to the nodes it
+                    changes, balances the copies and publishes them by
+                    swapping the root, so a reader walks one consistent
+                    version of the tree from the root it loaded. Readers
+                    take no locks and never retry: a lookup is a few atomic
+                    stores and loads plus the walk, so readers are
+                    wait-free. Writers are serialised by a mutex.
+
+                    Elements live in the nodes, as in AvlTree, so a lookup
+                    reads each key where it walks; a write copies the
+                    elements on its path along with the nodes.
+
+                    Replaced nodes are freed by epoch-based reclamation (see
+                    EpochReclamation.h): a reader holds a guard while it
+                    walks, and a writer retires what it replaced once the
+                    new root is published, so it is freed after every
+                    reader that could still see it has finished.
+
+ Sources:           The balance functions follow the AvlTree template class
+                    by Mark Allen Weiss, as found in Data Structures and
+                    Algorithm Analysis in C++ (4th ed).
+
+ ****************************************************************************/
+
+#include "EpochReclamation.h"
+#include "ThreeWayCompare.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <vector>
+using namespace std;
+
+// ConcurrentAvlTree class
+//
+// CONSTRUCTION: zero parameter
+//
+// ******************PUBLIC OPERATIONS*********************
+// Safe from any number of threads at once:
+// bool contains( x, count )   --> Return true if x is present; else false.
+//                                 Adds to count the nodes visited.
+// bool find( x, visit )       --> Calls visit( element ) on the element
+//                                 equal to x while it is safe to read, and
+//                                 returns true; else returns false.
+// void printNode( x )         --> Prints element in node containing x
+// boolean isEmpty( )          --> Return true if empty; else false
+// Safe with readers, one writer at a time (others wait):
+// void insert( x, count )     --> Insert x, merging it with an equal
+//                                 element. Adds to count the nodes visited.
+// bool remove( x, count )     --> Removes x. Adds to count the nodes
+//                                 visited.
+// void makeEmpty( )           --> Remove all items
+// With no other thread using the tree:
+// int nodes( )                --> Returns the number of nodes in the tree
+// void printTree( )           --> Print tree in sorted order
+// ******************ERRORS********************************
+// Throws CapacityException if too many threads use concurrent trees at once
+
+template <typename Comparable>
+class ConcurrentAvlTree
+{
+public:
+
+
+/******************************************************************************
+     PUBLIC CONSTRUCTORS, DESTRUCTORS
+******************************************************************************/
+
+    ConcurrentAvlTree( ) : root{ nullptr }, version{ 0 } { }
+
+    ConcurrentAvlTree( const ConcurrentAvlTree & rhs ) = delete;
+    ConcurrentAvlTree & operator=( const ConcurrentAvlTree & rhs ) = delete;
+
+    // No thread may be reading the tree when it is destroyed. The epoch
+    // domain, destroyed after this, frees what is still retired.
+    ~ConcurrentAvlTree( ) {
+        makeEmpty( );
+    }
+
+
+/******************************************************************************
+     PUBLIC READ FUNCTIONS
+******************************************************************************/
+
+    bool contains( const Comparable & x, int & count ) const {
+        ReadGuard guard( *this );
+        return find( x, guard.root( ), count ) != nullptr;
+    }
+
+    template <typename Visitor>
+    bool find( const Comparable & x, Visitor visit ) const {
+        ReadGuard guard( *this );
+        int count = 0;
+        AvlNode *t = find( x, guard.root( ), count );
+        if( t == nullptr )
+            return false;
+        visit( t->element );
+        return true;
+    }
+
+    void printNode( const Comparable & x ) const {
+        if( !find( x, [ ]( const Comparable & element ) { cout << element << endl; } ) )
+            cout << "Element not found in tree." << endl;
+    }
+
+    bool isEmpty( ) const {
+        return root.load( ) == nullptr;
+    }
+
+    int nodes( ) const {
+        int n = 0;
+        vector<AvlNode *> stack;
+        if( root.load( ) != nullptr )
+            stack.push_back( root.load( ) );
+        while( !stack.empty( ) ) {
+            AvlNode *t = stack.back( );
+            stack.pop_back( );
+            n++;
+            if( t->left != nullptr )
+                stack.push_back( t->left );
+            if( t->right != nullptr )
+                stack.push_back( t->right );
+        }
+        return n;
+    }
+
+    void printTree( ) const {
+        if( isEmpty( ) )
+            cout << "Empty tree" << endl;
+        else
+            printTree( root.load( ) );
+    }
+
+
+/******************************************************************************
+     PUBLIC WRITE FUNCTIONS
+******************************************************************************/
+
+    void insert( const Comparable & x, int & count ) {
+        lock_guard<mutex> guard( writer );
+        version++;
+        publish( insert( x, root.load( ), count ) );
+    }
+
+    bool remove( const Comparable & x, int & count ) {
+        lock_guard<mutex> guard( writer );
+        version++;
+        bool removed = false;
+        AvlNode *t = remove( x, root.load( ), count, removed );
+        if( removed )
+            publish( t );
+        return removed;
+    }
+
+    void makeEmpty( ) {
+        lock_guard<mutex> guard( writer );
+        AvlNode *old = root.exchange( nullptr );
+        retireAll( old );
+        publish( nullptr );
+    }
+
+
+private:
+
+    struct AvlNode
+    {
+        Comparable element;
+        AvlNode *left;
+        AvlNode *right;
+        int height;
+        uint64_t version;           // Write that made the node
+    };
+
+    /**
+     * Announces the calling thread as a reader for the life of the guard
+     */
+    class ReadGuard
+    {
+    public:
+        explicit ReadGuard( const ConcurrentAvlTree & tree )
+        : guard{ tree.epochs }, tree{ tree } { }
+
+        // Loaded after the epoch is announced, so nothing it reaches is
+        // freed while the guard lives
+        AvlNode * root( ) const {
+            return tree.root.load( );
+        }
+
+    private:
+        EpochDomain::Guard guard;
+        const ConcurrentAvlTree & tree;
+    };
+
+    atomic<AvlNode *> root;
+    EpochDomain epochs;
+
+    // Writer state, guarded by writer
+    mutex writer;
+    uint64_t version;
+    vector<AvlNode *> pending;      // Replaced by the write in progress
+
+
+/******************************************************************************
+     PRIVATE READ FUNCTIONS
+******************************************************************************/
+
+    int compare( const Comparable & x, const Comparable & y ) const {
+        long comparisons = 0;
+        return threeWayCompare( x, y, comparisons );
+    }
+
+    AvlNode * find( const Comparable & x, AvlNode *t, int & count ) const {
+        while( t != nullptr ) {
+            count++;
+            int order = compare( x, t->element );
+            if( order < 0 )
+                t = t->left;
+            else if( order > 0 )
+                t = t->right;
+            else
+                return t;
+        }
+        return nullptr;
+    }
+
+    int height( AvlNode *t ) const {
+        return t == nullptr ? -1 : t->height;
+    }
+
+    void printTree( AvlNode *t ) const {
+        if( t != nullptr ) {
+            printTree( t->left );
+            cout << t->element << endl;
+            printTree( t->right );
+        }
+    }
+
+
+/******************************************************************************
+     PRIVATE WRITE FUNCTIONS
+******************************************************************************/
+
+    /**
+     * Returns a copy of t that this write may change, retiring t. A node
+     * made by this write is not yet visible to readers, so it is returned
+     * as it is.
+     */
+    AvlNode * writable( AvlNode *t ) {
+        if( t->version == version )
+            return t;
+        pending.push_back( t );
+        return new AvlNode{ t->element, t->left, t->right, t->height, version };
+    }
+
+    /**
+     * Returns the subtree t with x inserted. Copies the path to x.
+     */
+    AvlNode * insert( const Comparable & x, AvlNode *t, int & count ) {
+        if( t == nullptr )
+            return new AvlNode{ x, nullptr, nullptr, 0, version };
+
+        count++;
+        int order = compare( x, t->element );
+        t = writable( t );
+        if( order < 0 )
+            t->left = insert( x, t->left, count );
+        else if( order > 0 )
+            t->right = insert( x, t->right, count );
+        else {
+            t->element.merge( x );
+            return t;
+        }
+        balance( t );
+        return t;
+    }
+
+    /**
+     * Returns the subtree t with x removed, and sets removed if x was there.
+     * Copies the path to x and, if x has two children, to its successor.
+     */
+    AvlNode * remove( const Comparable & x, AvlNode *t, int & count, bool & removed ) {
+        if( t == nullptr )
+            return t;
+
+        count++;
+        int order = compare( x, t->element );
+        if( order == 0 ) {
+            removed = true;
+            if( t->left != nullptr && t->right != nullptr ) {
+                t = writable( t );
+                t->element = findMin( t->right )->element;
+                t->right = removeMin( t->right );
+            }
+            else {
+                pending.push_back( t );
+                return ( t->left != nullptr ) ? t->left : t->right;
+            }
+        }
+        else {
+            AvlNode *child = remove( x, order < 0 ? t->left : t->right, count, removed );
+            if( !removed )
+                return t;
+            t = writable( t );
+            ( order < 0 ? t->left : t->right ) = child;
+        }
+        balance( t );
+        return t;
+    }
+
+    /**
+     * Returns the subtree t without its smallest node, whose element has
+     * been copied to the node being removed
+     */
+    AvlNode * removeMin( AvlNode *t ) {
+        if( t->left == nullptr ) {
+            pending.push_back( t );
+            return t->right;
+        }
+        t = writable( t );
+        t->left = removeMin( t->left );
+        balance( t );
+        return t;
+    }
+
+    AvlNode * findMin( AvlNode *t ) const {
+        while( t->left != nullptr )
+            t = t->left;
+        return t;
+    }
+
+    /**
+     * Makes t the root, then retires what this write replaced, which no
+     * reader that starts from now on can reach
+     */
+    void publish( AvlNode *t ) {
+        root.store( t );
+        for( AvlNode *replaced : pending )
+            epochs.retire( replaced );
+        pending.clear( );
+    }
+
+    /**
+     * Retires every node of the subtree t
+     */
+    void retireAll( AvlNode *t ) {
+        vector<AvlNode *> stack;
+        if( t != nullptr )
+            stack.push_back( t );
+        while( !stack.empty( ) ) {
+            t = stack.back( );
+            stack.pop_back( );
+            if( t->left != nullptr )
+                stack.push_back( t->left );
+            if( t->right != nullptr )
+                stack.push_back( t->right );
+            pending.push_back( t );
+        }
+    }
+
+
+/******************************************************************************
+     Balance Functions
+******************************************************************************/
+
+    static const int ALLOWED_IMBALANCE = 1;
+
+    // Assume t was made by this write and is within one of being balanced
+    void balance( AvlNode * & t ) {
+
+        if( height( t->left ) - height( t->right ) > ALLOWED_IMBALANCE ) {
+            if( height( t->left->left ) >= height( t->left->right ) )
+                rotateWithLeftChild( t );
+            else
+                doubleWithLeftChild( t );
+        }
+        else if( height( t->right ) - height( t->left ) > ALLOWED_IMBALANCE ) {
+            if( height( t->right->right ) >= height( t->right->left ) )
+                rotateWithRightChild( t );
+            else
+                doubleWithRightChild( t );
+        }
+
+        t->height = max( height( t->left ), height( t->right ) ) + 1;
+    }
+
+    /**
+     * Rotate binary tree node with left child, copying the child first.
+     * For AVL trees, this is a single rotation for case 1.
+     */
+    void rotateWithLeftChild( AvlNode * & k2 ) {
+        AvlNode *k1 = writable( k2->left );
+        k2->left = k1->right;
+        k1->right = k2;
+        k2->height = max( height( k2->left ), height( k2->right ) ) + 1;
+        k1->height = max( height( k1->left ), k2->height ) + 1;
+        k2 = k1;
+    }
+
+    /**
+     * Rotate binary tree node with right child, copying the child first.
+     * For AVL trees, this is a single rotation for case 4.
+     */
+    void rotateWithRightChild( AvlNode * & k1 ) {
+        AvlNode *k2 = writable( k1->right );
+        k1->right = k2->left;
+        k2->left = k1;
+        k1->height = max( height( k1->left ), height( k1->right ) ) + 1;
+        k2->height = max( height( k2->right ), k1->height ) + 1;
+        k1 = k2;
+    }
+
+    /**
+     * Double rotate binary tree node: first left child with its right
+     * child; then node k3 with new left child.
+     * For AVL trees, this is a double rotation for case 2.
+     */
+    void doubleWithLeftChild( AvlNode * & k3 ) {
+        k3->left = writable( k3->left );
+        rotateWithRightChild( k3->left );
+        rotateWithLeftChild( k3 );
+    }
+
+    /**
+     * Double rotate binary tree node: first right child with its left
+     * child; then node k1 with new right child.
+     * For AVL trees, this is a double rotation for case 3.
+     */
+    void doubleWithRightChild( AvlNode * & k1 ) {
+        k1->right = writable( k1->right );
+        rotateWithLeftChild( k1->right );
+        rotateWithRightChild( k1 );
+    }
+};
+
+#endif
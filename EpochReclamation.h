@@ -0,0 +1,211 @@
+#ifndef EPOCH_RECLAMATION_H
+#define EPOCH_RECLAMATION_H
+
+/*****************************************************************************
+ Title:             EpochReclamation.h
+ Created on:        October 18, 2026
+ Description:       Epoch-based reclamation for the concurrent containers.
+
+                    A thread that may follow pointers into a container holds
+                    an EpochDomain::Guard, which announces the global epoch
+                    in the thread's own slot and clears it when the guard
+                    goes. Memory that a thread has unlinked, so that no new
+                    reader can reach it, is handed to retire(), which tags
+                    it with the current epoch. It is freed once every thread
+                    that held a guard when it was retired has let go: that
+                    is, once every busy slot holds a newer epoch.
+
+                    Announcing an epoch is a load and a store, so guards
+                    never wait. Each thread keeps its own list of retired
+                    memory and frees from it every RETIRE_BATCH retires, so
+                    retiring never waits either.
+
+                    ReaderThreads gives each thread its slot index.
+
+ ****************************************************************************/
+
+#include "dsexceptions.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+/**
+ * Index of the calling thread among the threads alive at once, used to give
+ * each thread its own slot in every EpochDomain. Indexes of finished threads
+ * are reused. Throws CapacityException if more than MAX_THREADS threads use
+ * concurrent containers at once.
+ */
+class ReaderThreads
+{
+public:
+
+    static const int MAX_THREADS = 256;
+
+    static int index( ) {
+        thread_local Slot slot;
+        return slot.index;
+    }
+
+    // Returns one more than the highest index handed out so far, so only
+    // slots that have been used need to be looked at
+    static int used( ) {
+        return highest( ).load( );
+    }
+
+private:
+
+    struct Slot {
+        int index;
+
+        Slot( ) : index{ -1 } {
+            for( int i = 0; i < MAX_THREADS; i++ ) {
+                bool expected = false;
+                if( taken( )[ i ].compare_exchange_strong( expected, true ) ) {
+                    index = i;
+                    int seen = highest( ).load( );
+                    while( seen <= i && !highest( ).compare_exchange_weak( seen, i + 1 ) ) { }
+                    return;
+                }
+            }
+            throw CapacityException{ };
+        }
+
+        ~Slot( ) {
+            taken( )[ index ].store( false );
+        }
+    };
+
+    static atomic<bool> * taken( ) {
+        static atomic<bool> flags[ MAX_THREADS ];
+        return flags;
+    }
+
+    static atomic<int> & highest( ) {
+        static atomic<int> count{ 0 };
+        return count;
+    }
+};
+
+// EpochDomain class
+//
+// CONSTRUCTION: zero parameter
+//
+// ******************PUBLIC OPERATIONS*********************
+// Guard( domain )             --> Keeps memory retired from now on alive
+//                                 until the guard is destroyed. Guards of
+//                                 one thread may nest.
+// void retire( p )            --> Deletes p once no guard that could have
+//                                 seen it is left. p must already be
+//                                 unreachable for new guards.
+// ~EpochDomain( )             --> Deletes everything retired. No guard may
+//                                 be left.
+
+class EpochDomain
+{
+    struct Slot;
+
+public:
+
+    // Retires per thread between attempts to free
+    static const size_t RETIRE_BATCH = 64;
+
+    EpochDomain( ) : epoch{ 1 } { }
+
+    EpochDomain( const EpochDomain & rhs ) = delete;
+    EpochDomain & operator=( const EpochDomain & rhs ) = delete;
+
+    ~EpochDomain( ) {
+        for( Slot & slot : slots ) {
+            for( Retired & r : slot.retired )
+                r.destroy( r.pointer );
+        }
+    }
+
+    class Guard
+    {
+    public:
+        explicit Guard( const EpochDomain & domain )
+        : slot{ domain.slots[ ReaderThreads::index( ) ] } {
+            if( slot.depth++ == 0 )
+                slot.epoch.store( domain.epoch.load( ) );
+        }
+
+        // Release is enough here: every read under the guard must be done
+        // before the slot is seen clear, but nothing after it needs ordering
+        ~Guard( ) {
+            if( --slot.depth == 0 )
+                slot.epoch.store( 0, memory_order_release );
+        }
+
+        Guard( const Guard & rhs ) = delete;
+        Guard & operator=( const Guard & rhs ) = delete;
+
+    private:
+        Slot & slot;
+    };
+
+    template <typename T>
+    void retire( T *pointer ) {
+        Slot & slot = slots[ ReaderThreads::index( ) ];
+        slot.retired.push_back( Retired{ pointer, destroyAs<T>, epoch.load( ) } );
+        if( slot.retired.size( ) >= slot.collectAt )
+            collect( slot );
+    }
+
+private:
+
+    struct Retired
+    {
+        void *pointer;
+        void ( *destroy )( void * );
+        uint64_t epoch;             // Epoch when it became unreachable
+    };
+
+    // One per thread and cache line, so threads do not slow each other down.
+    // Only the owning thread touches depth and retired.
+    struct alignas( 64 ) Slot
+    {
+        atomic<uint64_t> epoch{ 0 };    // Epoch announced by a guard, or 0
+        int depth = 0;                  // Guards held
+        vector<Retired> retired;
+        size_t collectAt = RETIRE_BATCH;
+    };
+
+    mutable Slot slots[ ReaderThreads::MAX_THREADS ];
+    atomic<uint64_t> epoch;
+
+    template <typename T>
+    static void destroyAs( void *pointer ) {
+        delete static_cast<T *>( pointer );
+    }
+
+    /**
+     * Moves to a new epoch and frees what the thread of slot retired before
+     * the oldest epoch still announced
+     */
+    void collect( Slot & slot ) {
+        uint64_t oldest = epoch.fetch_add( 1 ) + 1;
+        int used = ReaderThreads::used( );
+        for( int i = 0; i < used; i++ ) {
+            uint64_t e = slots[ i ].epoch.load( );
+            if( e != 0 && e < oldest )
+                oldest = e;
+        }
+
+        size_t kept = 0;
+        for( size_t i = 0; i < slot.retired.size( ); i++ ) {
+            if( slot.retired[ i ].epoch < oldest )
+                slot.retired[ i ].destroy( slot.retired[ i ].pointer );
+            else
+                slot.retired[ kept++ ] = slot.retired[ i ];
+        }
+        slot.retired.resize( kept );
+
+        // If a long guard holds most of the list back, wait for more retires
+        // before looking again
+        slot.collectAt = kept + RETIRE_BATCH;
+    }
+};
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef FROZEN_SEQUENCE_INDEX_H
+#define FROZEN_SEQUENCE_INDEX_H
+
+/*****************************************************************************
+ Title:             FrozenSequenceIndex.h
+ Created on:        October 18, 2026
+ Description:       Read-only index of SequenceMaps for a database that no
+                    longer changes. Keys are stored in Eytzinger (BFS) order
+                    in a flat array: the children of slot k are slots 2k and
+                    2k+1. Each slot holds the PackedSequence key, so a level
+                    costs an integer compare. A search walks down the array
+                    without pointers or a data-dependent branch per level,
+                    and prefetches the slots two levels below the current
+                    one.
+
+                    Offers the same contains(x, count) and printNode(x)
+                    operations as the trees, so searchFromFile() and
+                    printSequenceMap() work with it unchanged.
+
+ ****************************************************************************/
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "PackedSequence.h"
+#include "SequenceMap.h"
+
+using namespace std;
+
+// FrozenSequenceIndex class
+//
+// CONSTRUCTION: from any tree that provides inOrder( visit )
+//
+// ******************PUBLIC OPERATIONS*********************
+// bool contains( x, count )   --> Return true if x is present; else false.
+//                                 Adds to count the number of levels
+//                                 searched.
+// boolean isEmpty( )          --> Return true if empty; else false
+// void printNode(x)           --> Prints element with the same key as x
+// int nodes( )                --> Returns the number of keys in the index
+// int internalPathLength( )   --> Returns the sum of the depth of all keys
+//                                 in the implicit tree.
+// long keyComparisons( )      --> Returns the number of key comparisons made
+//                                 by searches.
+
+class FrozenSequenceIndex
+{
+public:
+
+    /**
+     * Copies the elements of tree in sorted order into Eytzinger order
+     */
+    template <typename TreeType>
+    explicit FrozenSequenceIndex( const TreeType & tree ) : comparisons{ 0 } {
+        vector<const SequenceMap *> sorted;
+        tree.inOrder( [&sorted]( const SequenceMap & x ) { sorted.push_back( &x ); } );
+
+        keys.resize( sorted.size( ) + 1 );
+        elements.reserve( sorted.size( ) );
+
+        // order[k] is the index in sorted of the key stored in slot k
+        vector<size_t> order( sorted.size( ) + 1 );
+        size_t next = 0;
+        layout( order, next, 1 );
+
+        for ( size_t k = 1; k < order.size( ); k++ ) {
+            keys[ k ] = sorted[ order[ k ] ]->getKey( );
+            elements.push_back( *sorted[ order[ k ] ] );
+        }
+    }
+
+    /**
+     * Returns true if x is in the index. Else returns false
+     * Counts the number of levels searched
+     */
+    bool contains( const SequenceMap & x, int & count ) const {
+        return search( x.getKey( ), count ) != 0;
+    }
+
+    /**
+     * Prints contents of the element with the same key as x
+     */
+    void printNode( const SequenceMap & x ) const {
+        int count = 0;
+        size_t k = search( x.getKey( ), count );
+        if ( k == 0 ) {
+            cout << "Element not found in tree." << endl;
+        }
+        else {
+            cout << elements[ k - 1 ] << endl;
+        }
+    }
+
+    /**
+     * Test if the index is empty.
+     */
+    bool isEmpty( ) const {
+        return elements.empty( );
+    }
+
+    /**
+     * Returns number of keys in the index
+     */
+    int nodes( ) const {
+        return static_cast<int>( elements.size( ) );
+    }
+
+    /**
+     * Returns internal path length of the implicit tree. Slot k sits at
+     * depth floor(log2 k).
+     */
+    int internalPathLength( ) const {
+        int total = 0;
+        for ( size_t k = 1; k < keys.size( ); k++ ) {
+            int depth = 0;
+            for ( size_t j = k; j > 1; j >>= 1 )
+                depth++;
+            total += depth;
+        }
+        return total;
+    }
+
+    /**
+     * Returns the number of key comparisons made by searches
+     */
+    long keyComparisons( ) const {
+        return comparisons;
+    }
+
+private:
+
+    mutable long comparisons;       // Key comparisons made so far
+    vector<PackedSequence> keys;    // keys[1..n] in Eytzinger order
+    vector<SequenceMap> elements;   // elements[k-1] belongs to keys[k]
+
+    /**
+     * Fills order with an in-order walk of the implicit tree rooted at
+     * slot k, so slot k gets the next sorted index.
+     */
+    void layout( vector<size_t> & order, size_t & next, size_t k ) {
+        if ( k < order.size( ) ) {
+            layout( order, next, 2 * k );
+            order[ k ] = next++;
+            layout( order, next, 2 * k + 1 );
+        }
+    }
+
+    /**
+     * Returns the slot holding key, or 0 if key is not in the index.
+     * Walks to the bottom of the implicit tree going right whenever the
+     * slot is smaller than key, then undoes the trailing right turns to
+     * land on the first slot not smaller than key.
+     * Counts the number of levels searched.
+     */
+    size_t search( const PackedSequence & key, int & count ) const {
+        size_t n = keys.size( );
+        size_t k = 1;
+        int levels = 0;
+        while ( k < n ) {
+            if ( 4 * k + 3 < n ) {
+                __builtin_prefetch( &keys[ 4 * k ] );
+                __builtin_prefetch( &keys[ 4 * k + 3 ] );
+            }
+            k = 2 * k + ( keys[ k ] < key );
+            levels++;
+        }
+        k >>= __builtin_ffsll( ~k );
+        count += levels;
+        comparisons += levels + 1;
+
+        if ( k != 0 && keys[ k ] == key )
+            return k;
+        return 0;
+    }
+};
+
+#endif
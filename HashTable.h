@@ -0,0 +1,530 @@
+#ifndef HASH_TABLE_H
+#define HASH_TABLE_H
+
+/*****************************************************************************
+ Title:             HashTable.h
+ Created on:        October 18, 2026
+ Description:       Template class for a flat open-addressing hash table of
+                    elements, for exact-match lookups that never need the
+                    keys in order.
+
+                    Laid out in the style of a Swiss table. Elements live in
+                    one array of slots, and a parallel array holds one
+                    control byte per slot: empty, deleted, or 7 bits of the
+                    element's hash. Slots are probed 16 at a time, in
+                    groups: one SSE2 compare of a group's control bytes
+                    finds the slots whose hash bits match, so a key is
+                    compared only with the few elements likely to equal it.
+                    A search stops at the first group with an empty slot.
+                    Groups are visited in triangular order, which covers the
+                    whole table since it holds a power of two of them.
+
+                    The table grows to twice its size when it would be more
+                    than 7/8 full, counting deleted slots; if most of those
+                    are deleted, it is rebuilt at the same size instead.
+
+                    Comparable must have getKey( ), as SequenceMap does,
+                    returning a key with hash( ) and ==.
+
+ ****************************************************************************/
+
+#include "TreeSnapshot.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// HashTable class
+//
+// CONSTRUCTION: zero parameter
+//
+// ******************PUBLIC OPERATIONS*********************
+// void insert( x, count )     --> Insert x; duplicates are merged. Adds to
+//                                 count the groups probed.
+// bool remove( x, count )     --> Removes x. Adds to count the groups
+//                                 probed.
+// bool contains( x, count )   --> Return true if x is present; else false.
+//                                 Adds to count the groups probed.
+// vector<bool> containsBatch( xs, count )
+//                             --> Result i is true if xs[i] is present.
+//                                 Adds to count the groups probed.
+// boolean isEmpty( )          --> Return true if empty; else false
+// void makeEmpty( )           --> Remove all items
+// void printTree( )           --> Print table in sorted order
+// void printNode(x)           --> Prints element with the same key as x
+// void inOrder( visit )       --> Calls visit( element ) on every element
+//                                 in sorted order
+// int nodes( )                --> Returns the number of elements
+// int internalPathLength( )   --> Returns the sum over all elements of the
+//                                 groups probed to find each one
+// long keyComparisons( )      --> Returns the number of key comparisons made
+//                                 by insert, remove and contains
+// size_t capacity( )          --> Returns the number of slots
+// bool save( path, shape )    --> Writes the elements to a snapshot file
+//                                 (see TreeSnapshot.h). A hash table has no
+//                                 shape to save, so shape is ignored.
+//                                 Returns false on failure.
+// bool load( path )           --> Replaces the contents with a snapshot.
+//                                 Returns false, leaving the table as it
+//                                 was, if the file is not a valid snapshot.
+
+template <typename Comparable>
+class HashTable
+{
+public:
+
+
+/******************************************************************************
+     PUBLIC CONSTRUCTORS, DESTRUCTORS, MOVERS
+******************************************************************************/
+
+    HashTable( ) : control{ nullptr }, slots{ nullptr }, groups{ 0 }, size{ 0 }, growthLeft{ 0 },
+                   comparisons{ 0 } { }
+
+    HashTable( const HashTable & rhs ) = delete;
+    HashTable & operator=( const HashTable & rhs ) = delete;
+
+    HashTable( HashTable && rhs ) : HashTable( ) {
+        *this = std::move( rhs );
+    }
+
+    ~HashTable( ) {
+        makeEmpty( );
+    }
+
+    /**
+     * Move.
+     */
+    HashTable & operator=( HashTable && rhs ) {
+        std::swap( control, rhs.control );
+        std::swap( slots, rhs.slots );
+        std::swap( groups, rhs.groups );
+        std::swap( size, rhs.size );
+        std::swap( growthLeft, rhs.growthLeft );
+        std::swap( comparisons, rhs.comparisons );
+        return *this;
+    }
+
+
+/******************************************************************************
+     PUBLIC FIND FUNCTIONS
+******************************************************************************/
+
+    /**
+     * Returns true if x is found in the table. Else returns false
+     * Counts the groups probed
+     */
+    bool contains( const Comparable & x, int & count ) const {
+        return find( x, x.getKey( ).hash( ), count ) != NOT_FOUND;
+    }
+
+    /**
+     * Returns, for each query, true if it is found in the table
+     * Counts the groups probed
+     */
+    vector<bool> containsBatch( const vector<Comparable> & queries, int & count ) const {
+        vector<bool> results( queries.size( ) );
+        for( size_t i = 0; i < queries.size( ); i++ )
+            results[ i ] = contains( queries[ i ], count );
+        return results;
+    }
+
+
+/*****************************************************************************
+     PUBLIC PRINT FUNCTIONS
+*****************************************************************************/
+
+    /**
+     * Prints the element with the same key as x
+     */
+    void printNode( const Comparable & x ) const {
+        int count = 0;
+        size_t i = find( x, x.getKey( ).hash( ), count );
+        if( i == NOT_FOUND )
+            cout << "Element not found in tree." << endl;
+        else
+            cout << slots[ i ] << endl;
+    }
+
+    /**
+     * Print the table contents in sorted order.
+     */
+    void printTree( ) const {
+        if( isEmpty( ) )
+            cout << "Empty tree" << endl;
+        else
+            inOrder( [ ]( const Comparable & element ) { cout << element << endl; } );
+    }
+
+    /**
+     * Calls visit( element ) on every element in sorted order. The elements
+     * are sorted for each call.
+     */
+    template <typename Visitor>
+    void inOrder( Visitor visit ) const {
+        for( const Comparable *element : sorted( ) )
+            visit( *element );
+    }
+
+
+/*****************************************************************************
+     PUBLIC INSERT/REMOVE FUNCTIONS
+*****************************************************************************/
+
+    /**
+     * Make the table empty and free its slots.
+     */
+    void makeEmpty( ) {
+        for( size_t i = 0; i < capacity( ); i++ ) {
+            if( isFull( control[ i ] ) )
+                slots[ i ].~Comparable( );
+        }
+        delete [ ] control;
+        ::operator delete( slots );
+        control = nullptr;
+        slots = nullptr;
+        groups = 0;
+        size = 0;
+        growthLeft = 0;
+    }
+
+    /**
+     * Insert x into the table; duplicates are merged
+     * Counts the groups probed
+     */
+    void insert( const Comparable & x, int & count ) {
+        add( x, count );
+    }
+
+    void insert( Comparable && x, int & count ) {
+        add( std::move( x ), count );
+    }
+
+    /**
+     * Remove x from the table. Nothing is done if x is not found.
+     * Counts the groups probed
+     */
+    bool remove( const Comparable & x, int & count ) {
+        size_t i = find( x, x.getKey( ).hash( ), count );
+        if( i == NOT_FOUND )
+            return false;
+
+        slots[ i ].~Comparable( );
+        size--;
+        // A search never passes a group with an empty slot, so in such a
+        // group the slot can be empty again rather than deleted
+        if( Group( control + i / GROUP_SIZE * GROUP_SIZE ).matchEmpty( ) != 0 ) {
+            control[ i ] = EMPTY;
+            growthLeft++;
+        }
+        else
+            control[ i ] = DELETED;
+        return true;
+    }
+
+
+/******************************************************************************
+     PUBLIC SNAPSHOT FUNCTIONS
+******************************************************************************/
+
+    /**
+     * Writes the table to a snapshot file at path, its elements in sorted
+     * order. Returns false if the file could not be written.
+     */
+    bool save( const string & path, bool /*shape*/ = true ) const {
+        SnapshotWriter writer( false );
+        inOrder( [ &writer ]( const Comparable & element ) { writer.add( element, 0 ); } );
+        return writer.write( path );
+    }
+
+    /**
+     * Replaces the contents of the table with the snapshot at path. The
+     * table is sized for the snapshot first, so it never grows while
+     * loading.
+     * Returns false, leaving the table unchanged, if path is not a valid
+     * snapshot.
+     */
+    bool load( const string & path ) {
+        SnapshotReader reader( path );
+        if( reader.fail( ) )
+            return false;
+
+        makeEmpty( );
+        resize( groupsFor( reader.size( ) ) );
+        long saved = comparisons;
+        int count = 0;
+        for( size_t i = 0; i < reader.size( ); i++ )
+            add( reader.element( i ), count );
+        comparisons = saved;
+        return true;
+    }
+
+
+/******************************************************************************
+    PUBLIC FUNCTIONS TO GET TABLE CHARACTERISTICS
+ ******************************************************************************/
+
+    bool isEmpty( ) const {
+        return size == 0;
+    }
+
+    /**
+     * Returns the number of elements in the table
+     */
+    int nodes( ) const {
+        return static_cast<int>( size );
+    }
+
+    /**
+     * Returns the sum over all elements of the groups probed to find each
+     */
+    int internalPathLength( ) const {
+        int total = 0;
+        long saved = comparisons;
+        for( size_t i = 0; i < capacity( ); i++ ) {
+            if( isFull( control[ i ] ) )
+                find( slots[ i ], slots[ i ].getKey( ).hash( ), total );
+        }
+        comparisons = saved;
+        return total;
+    }
+
+    /**
+     * Returns the number of key comparisons made by insert, remove and
+     * contains since the table was created
+     */
+    long keyComparisons( ) const {
+        return comparisons;
+    }
+
+    size_t capacity( ) const {
+        return groups * GROUP_SIZE;
+    }
+
+
+private:
+
+/*****************************************************************************
+     Member Data
+*****************************************************************************/
+
+    static const size_t GROUP_SIZE = 16;
+    static const size_t NOT_FOUND = SIZE_MAX;
+
+    // Control bytes. A full slot holds the low 7 bits of its hash.
+    static const int8_t EMPTY = -128;
+    static const int8_t DELETED = -2;
+
+    /**
+     * The control bytes of one group, with masks of the slots that match.
+     * Bit i of a mask is slot i of the group.
+     */
+    class Group
+    {
+    public:
+#ifdef __SSE2__
+        explicit Group( const int8_t *bytes )
+        : bytes{ _mm_loadu_si128( reinterpret_cast<const __m128i *>( bytes ) ) } { }
+
+        uint32_t match( int8_t byte ) const {
+            return _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_set1_epi8( byte ), bytes ) );
+        }
+
+        // Empty and deleted are the only control bytes below -1
+        uint32_t matchEmptyOrDeleted( ) const {
+            return _mm_movemask_epi8( _mm_cmpgt_epi8( _mm_set1_epi8( -1 ), bytes ) );
+        }
+#else
+        explicit Group( const int8_t *bytes ) {
+            memcpy( this->bytes, bytes, GROUP_SIZE );
+        }
+
+        uint32_t match( int8_t byte ) const {
+            uint32_t mask = 0;
+            for( size_t i = 0; i < GROUP_SIZE; i++ )
+                mask |= static_cast<uint32_t>( bytes[ i ] == byte ) << i;
+            return mask;
+        }
+
+        uint32_t matchEmptyOrDeleted( ) const {
+            uint32_t mask = 0;
+            for( size_t i = 0; i < GROUP_SIZE; i++ )
+                mask |= static_cast<uint32_t>( bytes[ i ] < -1 ) << i;
+            return mask;
+        }
+#endif
+
+        uint32_t matchEmpty( ) const {
+            return match( EMPTY );
+        }
+
+    private:
+#ifdef __SSE2__
+        __m128i bytes;
+#else
+        int8_t bytes[ GROUP_SIZE ];
+#endif
+    };
+
+    int8_t *control;            // One byte per slot
+    Comparable *slots;          // Constructed only where control is full
+    size_t groups;              // A power of two, or 0 before the first insert
+    size_t size;                // Elements held
+    size_t growthLeft;          // Empty slots that may fill before growing
+    mutable long comparisons;   // Key comparisons made so far
+
+
+    static bool isFull( int8_t byte ) {
+        return byte >= 0;
+    }
+
+    static int8_t hashBits( size_t hash ) {
+        return static_cast<int8_t>( hash & 0x7F );
+    }
+
+    // Returns the lowest set bit of a nonzero mask
+    static int lowestBit( uint32_t mask ) {
+        return __builtin_ctz( mask );
+    }
+
+
+/*****************************************************************************
+     Find Functions
+*****************************************************************************/
+
+    /**
+     * Returns the slot holding the element with the same key as x, whose
+     * hash is hash, or NOT_FOUND
+     * Counts the groups probed
+     */
+    size_t find( const Comparable & x, size_t hash, int & count ) const {
+        if( groups == 0 )
+            return NOT_FOUND;
+
+        int8_t bits = hashBits( hash );
+        size_t g = ( hash >> 7 ) & ( groups - 1 );
+        for( size_t step = 1; ; step++ ) {
+            count++;
+            Group group( control + g * GROUP_SIZE );
+            for( uint32_t mask = group.match( bits ); mask != 0; mask &= mask - 1 ) {
+                size_t i = g * GROUP_SIZE + lowestBit( mask );
+                comparisons++;
+                if( slots[ i ].getKey( ) == x.getKey( ) )
+                    return i;
+            }
+            if( group.matchEmpty( ) != 0 )
+                return NOT_FOUND;
+            g = ( g + step ) & ( groups - 1 );
+        }
+    }
+
+    /**
+     * Returns the first empty or deleted slot on the probe sequence of hash
+     */
+    size_t findFree( size_t hash ) const {
+        size_t g = ( hash >> 7 ) & ( groups - 1 );
+        for( size_t step = 1; ; step++ ) {
+            uint32_t mask = Group( control + g * GROUP_SIZE ).matchEmptyOrDeleted( );
+            if( mask != 0 )
+                return g * GROUP_SIZE + lowestBit( mask );
+            g = ( g + step ) & ( groups - 1 );
+        }
+    }
+
+    /**
+     * Returns pointers to the elements in sorted order
+     */
+    vector<const Comparable *> sorted( ) const {
+        vector<const Comparable *> elements;
+        elements.reserve( size );
+        for( size_t i = 0; i < capacity( ); i++ ) {
+            if( isFull( control[ i ] ) )
+                elements.push_back( &slots[ i ] );
+        }
+        sort( elements.begin( ), elements.end( ), [ ]( const Comparable *a, const Comparable *b ) {
+            return *a < *b;
+        } );
+        return elements;
+    }
+
+
+/*****************************************************************************
+     Insert Functions
+*****************************************************************************/
+
+    /**
+     * Inserts x, merging it with the element with the same key if there is
+     * one
+     * Counts the groups probed
+     */
+    template <typename Element>
+    void add( Element && x, int & count ) {
+        size_t hash = x.getKey( ).hash( );
+        size_t i = find( x, hash, count );
+        if( i != NOT_FOUND ) {
+            slots[ i ].merge( std::forward<Element>( x ) );
+            return;
+        }
+
+        if( growthLeft == 0 ) {
+            // Rebuild at the same size if that frees enough deleted slots
+            resize( size < capacity( ) / 2 ? max<size_t>( groups, 1 ) : max<size_t>( 2 * groups, 1 ) );
+        }
+        i = findFree( hash );
+        if( control[ i ] == EMPTY )
+            growthLeft--;
+        control[ i ] = hashBits( hash );
+        new( &slots[ i ] ) Comparable( std::forward<Element>( x ) );
+        size++;
+    }
+
+    /**
+     * Returns the number of groups, a power of two, that holds n elements
+     * without growing
+     */
+    static size_t groupsFor( size_t n ) {
+        size_t g = 1;
+        while( g * GROUP_SIZE * 7 / 8 < n )
+            g *= 2;
+        return g;
+    }
+
+    /**
+     * Moves every element into a table of newGroups groups
+     */
+    void resize( size_t newGroups ) {
+        int8_t *oldControl = control;
+        Comparable *oldSlots = slots;
+        size_t oldCapacity = capacity( );
+
+        groups = newGroups;
+        control = new int8_t[ capacity( ) ];
+        memset( control, EMPTY, capacity( ) );
+        slots = static_cast<Comparable *>( ::operator new( capacity( ) * sizeof( Comparable ) ) );
+        growthLeft = capacity( ) * 7 / 8 - size;
+
+        for( size_t i = 0; i < oldCapacity; i++ ) {
+            if( isFull( oldControl[ i ] ) ) {
+                size_t hash = oldSlots[ i ].getKey( ).hash( );
+                size_t j = findFree( hash );
+                control[ j ] = hashBits( hash );
+                new( &slots[ j ] ) Comparable( std::move( oldSlots[ i ] ) );
+                oldSlots[ i ].~Comparable( );
+            }
+        }
+        delete [ ] oldControl;
+        ::operator delete( oldSlots );
+    }
+};
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef IUPAC_CODES_H
+#define IUPAC_CODES_H
+
+/*****************************************************************************
+ Title:             IupacCodes.h
+ Created on:        October 18, 2026
+ Description:       IUPAC nucleotide codes used in recognition sequences.
+                    Bases are numbered A 0, C 1, G 2 and T 3, and a set of
+                    bases is a 4-bit mask with bit i set for base i.
+
+                    iupacBases(c):      Bases the symbol c stands for
+                    baseIndex(c):       Number of the concrete base c
+                    iupacComplement(c): Symbol for the complementary bases
+
+ ****************************************************************************/
+
+/**
+ * Returns the mask of bases the IUPAC symbol c stands for, or 0 if c is not
+ * an IUPAC symbol
+ */
+inline int iupacBases( char c ) {
+    switch ( c ) {
+        case 'A': return 1;
+        case 'C': return 2;
+        case 'G': return 4;
+        case 'T': return 8;
+        case 'R': return 1 | 4;
+        case 'Y': return 2 | 8;
+        case 'S': return 2 | 4;
+        case 'W': return 1 | 8;
+        case 'K': return 4 | 8;
+        case 'M': return 1 | 2;
+        case 'B': return 2 | 4 | 8;
+        case 'D': return 1 | 4 | 8;
+        case 'H': return 1 | 2 | 8;
+        case 'V': return 1 | 2 | 4;
+        case 'N': return 1 | 2 | 4 | 8;
+        default: return 0;
+    }
+}
+
+/**
+ * Returns 0-3 for the base c (A, C, G or T in either case), or -1
+ */
+inline int baseIndex( char c ) {
+    switch ( c ) {
+        case 'A': case 'a': return 0;
+        case 'C': case 'c': return 1;
+        case 'G': case 'g': return 2;
+        case 'T': case 't': return 3;
+        default: return -1;
+    }
+}
+
+/**
+ * Returns the IUPAC symbol for the complements of the bases c stands for,
+ * or c itself if it is not an IUPAC symbol
+ */
+inline char iupacComplement( char c ) {
+    switch ( c ) {
+        case 'A': return 'T';
+        case 'C': return 'G';
+        case 'G': return 'C';
+        case 'T': return 'A';
+        case 'R': return 'Y';
+        case 'Y': return 'R';
+        case 'K': return 'M';
+        case 'M': return 'K';
+        case 'B': return 'V';
+        case 'V': return 'B';
+        case 'D': return 'H';
+        case 'H': return 'D';
+        default: return c;      // S, W and N are their own complements
+    }
+}
+
+#endif
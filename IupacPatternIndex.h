@@ -0,0 +1,261 @@
+#ifndef IUPAC_PATTERN_INDEX_H
+#define IUPAC_PATTERN_INDEX_H
+
+/*****************************************************************************
+ Title:             IupacPatternIndex.h
+ Created on:        October 18, 2026
+ Description:       Index of recognition sequences for pattern queries.
+                    Given a concrete DNA fragment of A, C, G and T, finds
+                    every stored site whose degenerate IUPAC pattern
+                    matches the whole fragment, e.g. GAANNNNTTC matches
+                    GAACGTGTTC. The ' cut marker is ignored.
+
+                    Sites are stored in a trie over the 15 IUPAC symbols.
+                    Each trie node keeps a 16-bit mask of the symbols that
+                    have a child, and its children sit next to each other
+                    in one array, so a child is found by counting bits.
+                    A query base selects every child whose symbol includes
+                    it with one AND against a precomputed mask, so only the
+                    branches that can still match are walked.
+
+                    Offers printNode(x) like the trees, so printSequenceMap()
+                    works with it unchanged.
+
+ ****************************************************************************/
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "IupacCodes.h"
+#include "SequenceMap.h"
+
+using namespace std;
+
+// IupacPatternIndex class
+//
+// CONSTRUCTION: from any tree that provides inOrder( visit )
+//
+// ******************PUBLIC OPERATIONS*********************
+// match( fragment, count )    --> Returns the elements whose sequence
+//                                 matches fragment, in sorted order. Adds
+//                                 to count the number of trie nodes visited.
+// void printNode(x)           --> Prints every element whose sequence
+//                                 matches the sequence of x
+// bool matches( site, fragment ) --> True if the IUPAC pattern site matches
+//                                 fragment. Checks one site by itself.
+// boolean isEmpty( )          --> Return true if empty; else false
+// int sites( )                --> Returns the number of sites indexed
+// int trieNodes( )            --> Returns the number of nodes in the trie
+
+class IupacPatternIndex
+{
+public:
+
+    /**
+     * Indexes every element of tree that holds only IUPAC symbols and the
+     * cut marker. Other sequences cannot match a DNA fragment.
+     */
+    template <typename TreeType>
+    explicit IupacPatternIndex( const TreeType & tree ) {
+        for ( int base = 0; base < 4; base++ )
+            allowedSymbols[ base ] = matching( base );
+
+        // Trie built with a full child table per node, then flattened
+        vector<vector<int>> children( 1, vector<int>( SYMBOL_COUNT, -1 ) );
+        vector<vector<int>> ends( 1 );
+
+        tree.inOrder( [&]( const SequenceMap & x ) {
+            string site = x.getSequence( );
+            int node = 0;
+            for ( char c : site ) {
+                if ( c == '\'' )
+                    continue;
+                int code = symbolCode( c );
+                if ( code < 0 )
+                    return;
+                if ( children[ node ][ code ] < 0 ) {
+                    children[ node ][ code ] = static_cast<int>( children.size( ) );
+                    children.push_back( vector<int>( SYMBOL_COUNT, -1 ) );
+                    ends.push_back( vector<int>( ) );
+                }
+                node = children[ node ][ code ];
+            }
+            ends[ node ].push_back( static_cast<int>( elements.size( ) ) );
+            elements.push_back( x );
+        } );
+
+        flatten( children, ends );
+    }
+
+    /**
+     * Returns the elements whose sequence matches fragment, in sorted
+     * order. fragment must be made of A, C, G and T, in either case.
+     * Counts the number of trie nodes visited
+     */
+    vector<const SequenceMap *> match( const string & fragment, int & count ) const {
+        vector<const SequenceMap *> found;
+
+        // Symbols that each base of the fragment can match
+        vector<uint16_t> allowed( fragment.size( ) );
+        for ( size_t i = 0; i < fragment.size( ); i++ ) {
+            int base = baseIndex( fragment[ i ] );
+            if ( base < 0 )
+                return found;
+            allowed[ i ] = allowedSymbols[ base ];
+        }
+
+        vector<pair<uint32_t, size_t>> stack;
+        stack.push_back( make_pair( 0, 0 ) );
+        while ( !stack.empty( ) ) {
+            const TrieNode & node = trie[ stack.back( ).first ];
+            size_t depth = stack.back( ).second;
+            stack.pop_back( );
+            count++;
+
+            if ( depth == fragment.size( ) ) {
+                for ( uint32_t i = 0; i < node.siteCount; i++ )
+                    found.push_back( &elements[ siteIds[ node.firstSite + i ] ] );
+                continue;
+            }
+
+            uint16_t next = node.present & allowed[ depth ];
+            while ( next != 0 ) {
+                int code = __builtin_ctz( next );
+                next &= next - 1;
+                uint32_t child = node.firstChild + __builtin_popcount( node.present & ( ( 1u << code ) - 1 ) );
+                stack.push_back( make_pair( child, depth + 1 ) );
+            }
+        }
+
+        // elements is sorted, so sorting the pointers sorts the matches
+        sort( found.begin( ), found.end( ) );
+        return found;
+    }
+
+    /**
+     * Prints every element whose sequence matches the sequence of x
+     */
+    void printNode( const SequenceMap & x ) const {
+        int count = 0;
+        vector<const SequenceMap *> found = match( x.getSequence( ), count );
+        if ( found.empty( ) ) {
+            cout << "Element not found in tree." << endl;
+        }
+        for ( const SequenceMap *site : found ) {
+            cout << "SITE: " << site->getSequence( ) << endl;
+            cout << *site << endl;
+        }
+    }
+
+    /**
+     * Returns true if the IUPAC pattern site, ignoring its cut marker,
+     * matches all of fragment
+     */
+    static bool matches( const string & site, const string & fragment ) {
+        size_t i = 0;
+        for ( char c : site ) {
+            if ( c == '\'' )
+                continue;
+            int code = symbolCode( c );
+            if ( i == fragment.size( ) || code < 0 )
+                return false;
+            int base = baseIndex( fragment[ i++ ] );
+            if ( base < 0 || !( iupacBases( c ) & ( 1 << base ) ) )
+                return false;
+        }
+        return i == fragment.size( );
+    }
+
+    /**
+     * Test if the index is empty.
+     */
+    bool isEmpty( ) const {
+        return elements.empty( );
+    }
+
+    /**
+     * Returns number of sites in the index
+     */
+    int sites( ) const {
+        return static_cast<int>( elements.size( ) );
+    }
+
+    /**
+     * Returns number of nodes in the trie
+     */
+    int trieNodes( ) const {
+        return static_cast<int>( trie.size( ) );
+    }
+
+private:
+
+    struct TrieNode {
+        uint16_t present;       // Bit i set if there is a child for symbol i
+        uint16_t siteCount;     // Number of sites ending here
+        uint32_t firstChild;    // Index in trie of the child with the lowest symbol
+        uint32_t firstSite;     // Index in siteIds of the first site ending here
+    };
+
+    static const int SYMBOL_COUNT = 15;
+
+    // IUPAC symbols in code order
+    static constexpr const char * SYMBOLS = "ACGTRYSWKMBDHVN";
+
+    uint16_t allowedSymbols[ 4 ];   // Mask of symbol codes that stand for each base
+    vector<TrieNode> trie;          // trie[ 0 ] is the root
+    vector<uint32_t> siteIds;       // Sites ending at each node, by node
+    vector<SequenceMap> elements;   // Indexed elements in sorted order
+
+    /**
+     * Returns the code of IUPAC symbol c, or -1 if c is not one
+     */
+    static int symbolCode( char c ) {
+        for ( int i = 0; i < SYMBOL_COUNT; i++ ) {
+            if ( SYMBOLS[ i ] == c )
+                return i;
+        }
+        return -1;
+    }
+
+    /**
+     * Returns the mask of symbol codes that stand for base
+     */
+    static uint16_t matching( int base ) {
+        uint16_t mask = 0;
+        for ( int i = 0; i < SYMBOL_COUNT; i++ ) {
+            if ( iupacBases( SYMBOLS[ i ] ) & ( 1 << base ) )
+                mask |= 1 << i;
+        }
+        return mask;
+    }
+
+    /**
+     * Lays the trie out in breadth-first order, so the children of each
+     * node are next to each other, lowest symbol first.
+     */
+    void flatten( const vector<vector<int>> & children, const vector<vector<int>> & ends ) {
+        vector<int> order( 1, 0 );      // Build ids in breadth-first order
+        trie.resize( children.size( ) );
+
+        for ( size_t n = 0; n < order.size( ); n++ ) {
+            int id = order[ n ];
+            TrieNode & node = trie[ n ];
+            node.present = 0;
+            node.firstChild = static_cast<uint32_t>( order.size( ) );
+            for ( int code = 0; code < SYMBOL_COUNT; code++ ) {
+                if ( children[ id ][ code ] >= 0 ) {
+                    node.present |= 1 << code;
+                    order.push_back( children[ id ][ code ] );
+                }
+            }
+            node.firstSite = static_cast<uint32_t>( siteIds.size( ) );
+            node.siteCount = static_cast<uint16_t>( ends[ id ].size( ) );
+            siteIds.insert( siteIds.end( ), ends[ id ].begin( ), ends[ id ].end( ) );
+        }
+    }
+};
+
+#endif
@@ -17,14 +17,23 @@
 *****************************************************************************/
 
 
+#include "BatchQuery.h"
 #include "dsexceptions.h"
+#include "NodePool.h"
+#include "ThreeWayCompare.h"
+#include "TreeIterator.h"
+#include "TreeSnapshot.h"
 #include <algorithm>
 #include <iostream>
+#include <numeric>
+#include <utility>
+#include <vector>
 using namespace std;
 
 // AVL Tree with Lazy Deletion class
 //
-// CONSTRUCTION: zero parameter
+// CONSTRUCTION: zero parameter. Nodes come from Allocator, a NodePool by
+//               default (see NodePool.h).
 //
 // ******************PUBLIC OPERATIONS*********************
 // void insert( x, count )     --> Insert x. Adds to count the number of
@@ -34,34 +43,83 @@ using namespace std;
 // bool contains( x, count )   --> Return true if x is present; else false.
 //                                 Adds to count the number of recursive calls
 //                                 made.
+// vector<bool> containsBatch( xs, count )
+//                             --> Result i is true if xs[i] is present.
+//                                 Answers all of xs in one walk of the
+//                                 tree. Adds to count the nodes visited.
+// findBatch( xs, count )      --> As containsBatch, but result i points to
+//                                 the element equal to xs[i], or is nullptr.
 // Comparable findMin( )       --> Return smallest item
 // Comparable findMax( )       --> Return largest item
 // boolean isEmpty( )          --> Return true if empty; else false
 // void makeEmpty( )           --> Remove all items
 // void printTree( )           --> Print tree in sorted order
 // void printNode(x)           --> Prints element in node containing x
-// int nodes( )                --> Returns the number of nodes in the tree
+// void inOrder( visit )       --> Calls visit( element ) on every
+//                                 non-deleted element in sorted order
+// const_iterator begin( )     --> Iterator to the smallest non-deleted element
+// const_iterator end( )       --> Iterator past the largest element
+// const_iterator lowerBound( x )
+//                             --> Iterator to the first non-deleted element not
+//                                 less than x, or end( )
+// const_iterator upperBound( x )
+//                             --> Iterator to the first non-deleted element
+//                                 greater than x, or end( )
+// range( lo, hi )             --> The non-deleted elements from lo to hi
+//                                 inclusive, in sorted order
+// prefix( p )                 --> The non-deleted elements whose key starts with
+//                                 the key of p, in sorted order
+// void compact( )             --> Rebuild a balanced tree from the
+//                                 non-deleted nodes and free the deleted ones
+// void setCompactionThreshold( f ) --> remove( ) compacts once more than
+//                                 fraction f of the nodes are deleted. f of
+//                                 1 or more turns this off.
+// int nodes( )                --> Returns the number of nodes in the tree,
+//                                 deleted or not
+// int liveNodes( )            --> Returns the number of non-deleted nodes
+// int deletedNodes( )         --> Returns the number of deleted nodes
+// int rank( x )               --> Returns the number of non-deleted elements
+//                                 less than x
+// Comparable select( k )      --> Return the non-deleted element of rank k,
+//                                 from 0
 // int internalPathLength( )   --> Returns the sum of the depth of all nodes
 //                                 in the tree.
+// long keyComparisons( )      --> Returns the number of key comparisons made
+//                                 by insert, remove, contains, find and
+//                                 rank.
+// bool save( path, shape )    --> Writes the tree to a snapshot file (see
+//                                 TreeSnapshot.h), with its shape unless
+//                                 shape is false. Returns false on failure.
+// bool load( path )           --> Replaces the contents with a snapshot.
+//                                 Returns false, leaving the tree as it
+//                                 was, if the file is not a valid snapshot.
 // ******************ERRORS********************************
-// Throws UnderflowException as warranted
+// Throws UnderflowException and ArrayIndexOutOfBoundsException as warranted
 
-template <typename Comparable>
+template <typename Comparable, template <typename> class Allocator = NodePool>
 class LazyAvlTree
 {
+    struct LazyAvlNode;
+
 public:
     
 /******************************************************************************
      PUBLIC CONSTRUCTORS, DESTRUCTORS, MOVERS
 ******************************************************************************/
-    LazyAvlTree( ) : root{ nullptr } { }
+    LazyAvlTree( ) : root{ nullptr }, comparisons{ 0 }, liveCount{ 0 }, deletedCount{ 0 },
+        compactionThreshold{ DEFAULT_COMPACTION_THRESHOLD } { }
     
-    LazyAvlTree( const LazyAvlTree & rhs ) : root{ nullptr } {
+    LazyAvlTree( const LazyAvlTree & rhs ) : root{ nullptr }, comparisons{ 0 },
+        liveCount{ rhs.liveCount }, deletedCount{ rhs.deletedCount },
+        compactionThreshold{ rhs.compactionThreshold } {
         root = clone( rhs.root );
     }
     
-    LazyAvlTree( LazyAvlTree && rhs ) : root{ rhs.root } {
+    LazyAvlTree( LazyAvlTree && rhs ) : root{ rhs.root }, pool{ std::move( rhs.pool ) }, comparisons{ rhs.comparisons },
+        liveCount{ rhs.liveCount }, deletedCount{ rhs.deletedCount },
+        compactionThreshold{ rhs.compactionThreshold } {
         rhs.root = nullptr;
+        rhs.liveCount = rhs.deletedCount = 0;
     }
     
     ~LazyAvlTree( ) {
@@ -82,6 +140,11 @@ public:
      */
     LazyAvlTree & operator=( LazyAvlTree && rhs ) {
         std::swap( root, rhs.root );
+        std::swap( pool, rhs.pool );
+        std::swap( comparisons, rhs.comparisons );
+        std::swap( liveCount, rhs.liveCount );
+        std::swap( deletedCount, rhs.deletedCount );
+        std::swap( compactionThreshold, rhs.compactionThreshold );
         
         return *this;
     }
@@ -118,6 +181,151 @@ public:
         return contains( x, root, count );
     }
     
+    /**
+     * Returns, for each query, a pointer to the element equal to it or
+     * nullptr if there is none. Queries are taken BATCH_WINDOW at a time,
+     * small enough to sort in cache; each window is sorted and answered in
+     * one walk down the tree, visiting each node at most once. Queries are
+     * ordered by the prefixes of their keys (see keyPrefix( )), so whole
+     * keys are only compared where the prefixes are equal, and a window
+     * that is already sorted is not sorted again (see sortBatch( )).
+     * Sorting costs about as much as the searches it saves while the tree
+     * fits in the cache, so for SequenceMap this is no faster than one
+     * contains( ) per query up to about 1000 nodes, and 1.3 to 1.7 times
+     * faster from about 30k nodes.
+     * Counts the number of nodes visited
+     */
+    vector<const Comparable *> findBatch( const vector<Comparable> & queries, int & count ) const {
+        vector<const Comparable *> results( queries.size( ), nullptr );
+        if ( root == nullptr )
+            return results;
+        
+        vector<BatchQuery> order;
+        auto less = [ this, &queries ]( const BatchQuery & a, const BatchQuery & b ) {
+            return compare( queries[ a.index ], a.prefix, queries[ b.index ], b.prefix ) < 0;
+        };
+        for ( size_t start = 0; start < queries.size( ); start += BATCH_WINDOW ) {
+            order.resize( min( BATCH_WINDOW, queries.size( ) - start ) );
+            for ( size_t i = 0; i < order.size( ); i++ )
+                order[ i ] = { keyPrefix( queries[ start + i ] ), start + i };
+            if ( !is_sorted( order.begin( ), order.end( ), less ) )
+                sortBatch( order, less );
+            findBatch( queries, order, results, count );
+        }
+        return results;
+    }
+    
+    /**
+     * Returns, for each query, true if it is found in the tree
+     * Counts the number of nodes visited
+     */
+    vector<bool> containsBatch( const vector<Comparable> & queries, int & count ) const {
+        vector<const Comparable *> found = findBatch( queries, count );
+        vector<bool> results( found.size( ) );
+        for ( size_t i = 0; i < found.size( ); i++ )
+            results[ i ] = found[ i ] != nullptr;
+        return results;
+    }
+    
+    /**
+     * Returns the number of non-deleted elements less than x, whether or
+     * not x is in the tree. One walk down the tree, adding up the live
+     * counts of the left subtrees passed on the right.
+     */
+    int rank( const Comparable & x ) const {
+        int r = 0;
+        LazyAvlNode *t = root;
+        while( t != nullptr ) {
+            int cmp = compare( x, t->element );
+            if( cmp == 0 )
+                return r + live( t->left );
+            if( cmp < 0 )
+                t = t->left;
+            else {
+                r += live( t->left ) + !t->isDeleted;
+                t = t->right;
+            }
+        }
+        return r;
+    }
+    
+    /**
+     * Returns the non-deleted element of rank k, the (k+1)th smallest.
+     * One walk down the tree, comparing k with the live counts of the left
+     * subtrees; deleted nodes are passed over.
+     * Throw ArrayIndexOutOfBoundsException if k is not in [0, liveNodes( )).
+     */
+    const Comparable & select( int k ) const {
+        if( k < 0 || k >= live( root ) )
+            throw ArrayIndexOutOfBoundsException{ };
+        LazyAvlNode *t = root;
+        while( t->isDeleted || k != live( t->left ) ) {
+            if( k < live( t->left ) )
+                t = t->left;
+            else {
+                k -= live( t->left ) + !t->isDeleted;
+                t = t->right;
+            }
+        }
+        return t->element;
+    }
+    
+/******************************************************************************
+     PUBLIC ITERATOR FUNCTIONS
+******************************************************************************/
+    
+    typedef TreeIterator<LazyAvlNode, Comparable> const_iterator;
+    
+    /**
+     * Returns an iterator to the smallest element, walking the tree in
+     * sorted order, skipping deleted nodes
+     */
+    const_iterator begin( ) const {
+        return const_iterator( root, [ ]( const Comparable & ) { return true; } );
+    }
+    
+    const_iterator end( ) const {
+        return const_iterator( );
+    }
+    
+    /**
+     * Returns an iterator to the first non-deleted element not less than x
+     */
+    const_iterator lowerBound( const Comparable & x ) const {
+        return const_iterator( root, [ &x ]( const Comparable & element ) { return !( element < x ); } );
+    }
+    
+    /**
+     * Returns an iterator to the first non-deleted element greater than x
+     */
+    const_iterator upperBound( const Comparable & x ) const {
+        return const_iterator( root, [ &x ]( const Comparable & element ) { return x < element; } );
+    }
+    
+    /**
+     * Returns the non-deleted elements from lo to hi inclusive, in sorted order.
+     * Finding the ends costs two walks down the tree; the elements are
+     * not copied. The range is empty if hi is less than lo.
+     */
+    TreeRange<const_iterator> range( const Comparable & lo, const Comparable & hi ) const {
+        if( hi < lo )
+            return TreeRange<const_iterator>( end( ), end( ) );
+        return TreeRange<const_iterator>( lowerBound( lo ), upperBound( hi ) );
+    }
+    
+    /**
+     * Returns the non-deleted elements whose key starts with the key of p, in sorted
+     * order. They follow one another from lowerBound( p ), up to the first
+     * element past p that does not start with it.
+     * Comparable must have startsWith( p ), as SequenceMap does.
+     */
+    TreeRange<const_iterator> prefix( const Comparable & p ) const {
+        const_iterator last( root, [ &p ]( const Comparable & element ) {
+            return p < element && !element.startsWith( p );
+        } );
+        return TreeRange<const_iterator>( lowerBound( p ), last );
+    }
+    
 /******************************************************************************
      PUBLIC PRINT FUNCTIONS
 ******************************************************************************/
@@ -145,16 +353,30 @@ public:
             printTree( root );
     }
     
+    /**
+     * Calls visit( element ) on every non-deleted element in sorted order
+     */
+    template <typename Visitor>
+    void inOrder( Visitor visit ) const {
+        inOrder( root, visit );
+    }
+    
 /******************************************************************************
      PUBLIC INSERT/REMOVE FUNCTIONS
 ******************************************************************************/
     
     /**
      * Make the tree logically empty.
+     * A pooled allocator frees its chunks in one go, so the node walk is
+     * only needed to run element destructors or for per-node allocators.
      */
-    void makeEmpty( )
-    {
-        makeEmpty( root );
+    void makeEmpty( ) {
+        if( Allocator<LazyAvlNode>::bulk_release && is_trivially_destructible<Comparable>::value )
+            root = nullptr;
+        else
+            makeEmpty( root );
+        pool.release( );
+        liveCount = deletedCount = 0;
     }
     
     /**
@@ -171,11 +393,107 @@ public:
     
     /**
      * Remove x from the tree. Nothing is done if x is not found.
+     * Compacts the tree if this takes the fraction of deleted nodes over
+     * the compaction threshold.
      * Counts the number of recursive calls made to remove
      */
     bool remove( const Comparable & x, int &count) {
-        return remove( x, root, count );
+        if( !remove( x, root, count ) )
+            return false;
+        if( deletedCount > compactionThreshold * ( liveCount + deletedCount ) )
+            compact( );
+        return true;
+    }
+    
+    /**
+     * Rebuild the tree from its non-deleted nodes, perfectly balanced, and
+     * free the deleted nodes. Nodes are relinked, not copied.
+     */
+    void compact( ) {
+        vector<LazyAvlNode *> live;
+        live.reserve( liveCount );
         
+        // Walk the tree in order, keeping live nodes and freeing the rest
+        vector<LazyAvlNode *> stack;
+        LazyAvlNode *t = root;
+        while( t != nullptr || !stack.empty( ) ) {
+            while( t != nullptr ) {
+                stack.push_back( t );
+                t = t->left;
+            }
+            t = stack.back( );
+            stack.pop_back( );
+            LazyAvlNode *next = t->right;
+            if( t->isDeleted )
+                pool.destroy( t );
+            else
+                live.push_back( t );
+            t = next;
+        }
+        
+        root = buildBalanced( live, 0, static_cast<int>( live.size( ) ) - 1 );
+        deletedCount = 0;
+    }
+    
+    /**
+     * Set the fraction of deleted nodes above which remove( ) compacts the
+     * tree. A fraction of 1 or more turns automatic compaction off.
+     */
+    void setCompactionThreshold( double fraction ) {
+        compactionThreshold = fraction;
+    }
+    
+/******************************************************************************
+     PUBLIC SNAPSHOT FUNCTIONS
+******************************************************************************/
+    
+    /**
+     * Writes the tree to a snapshot file at path: its elements in sorted
+     * order and, if shape is true, the depth of each so load( ) rebuilds
+     * this exact tree. Returns false if the file could not be written.
+     */
+    bool save( const string & path, bool shape = true ) const {
+        SnapshotWriter writer( shape );
+        inOrderWithDepth( root, [ &writer ]( LazyAvlNode *t, uint32_t depth ) {
+            writer.add( t->element, depth, t->isDeleted );
+        } );
+        return writer.write( path );
+    }
+    
+    /**
+     * Replaces the contents of the tree with the snapshot at path. Nodes
+     * are created in sorted order and linked by depth, so no keys are
+     * compared. A snapshot without a shape, or whose shape breaks the AVL
+     * balance condition, gives a balanced tree.
+     * Returns false, leaving the tree unchanged, if path is not a valid
+     * snapshot.
+     */
+    bool load( const string & path ) {
+        SnapshotReader reader( path );
+        if ( reader.fail( ) )
+            return false;
+        
+        makeEmpty( );
+        vector<LazyAvlNode *> nodes;
+        nodes.reserve( reader.size( ) );
+        for ( size_t i = 0; i < reader.size( ); i++ )
+            nodes.push_back( pool.create( reader.element( i ), nullptr, nullptr, 0, reader.isDeleted( i ) ) );
+        
+        // A shape saved from a tree that is not an AVL tree is replaced by
+        // a balanced one
+        bool balanced = true;
+        auto finish = [ this, &balanced ]( LazyAvlNode *t ) {
+            update( t );
+            balanced = balanced && abs( height( t->left ) - height( t->right ) ) <= ALLOWED_IMBALANCE;
+        };
+        root = linkByDepth( nodes, reader.depths( ), finish );
+        if ( !balanced )
+            root = linkByDepth( nodes, reader.balancedDepths( ), finish );
+        deletedCount = 0;
+        for ( size_t i = 0; i < reader.size( ); i++ )
+            deletedCount += reader.isDeleted( i );
+        liveCount = static_cast<int>( reader.size( ) ) - deletedCount;
+        return true;
     }
     
 /******************************************************************************
@@ -191,19 +509,41 @@ public:
     }
 
     /**
-     * Returns number of nodes in the tree
+     * Returns number of nodes in the tree, including deleted nodes
      */
-    int nodes ( ) {
-        return countNodes(root);
+    int nodes ( ) const {
+        return liveCount + deletedCount;
     }
     
+    /**
+     * Returns number of nodes not marked as deleted
+     */
+    int liveNodes ( ) const {
+        return liveCount;
+    }
+    
+    /**
+     * Returns number of nodes marked as deleted
+     */
+    int deletedNodes ( ) const {
+        return deletedCount;
+    }
+    
+    
+    /**
+     * Returns internal path length, i.e. sum of depth of all nodes in tree,
+     * kept in the root
+     */
+    int internalPathLength() const {
+        return root == nullptr ? 0 : root->depths;
+    }
     
     /**
-     * Returns internal path length, i.e. sum of depth of all nodes in tree
+     * Returns the number of key comparisons made by insert, remove,
+     * contains, find and rank since the tree was created
      */
-    int internalPathLength() {
-        int start = 0;
-        return totalDepth(root, start);
+    long keyComparisons( ) const {
+        return comparisons;
     }
 
     
@@ -218,85 +558,179 @@ private:
         LazyAvlNode *left;
         LazyAvlNode *right;
         int height;
+        int size;       // Nodes in the subtree rooted here, deleted or not
+        int live;       // Nodes in the subtree not marked as deleted
+        int depths;     // Sum of the depths of all its nodes below this one
         bool isDeleted;
         
         LazyAvlNode( const Comparable & ele, LazyAvlNode *lt, LazyAvlNode *rt, int h = 0, bool del = false)
-        : element{ ele }, left{ lt }, right{ rt }, height{ h }, isDeleted{ del } { }
+        : element{ ele }, left{ lt }, right{ rt }, height{ h }, size{ 1 }, live{ !del }, depths{ 0 },
+          isDeleted{ del } { }
         
         LazyAvlNode( Comparable && ele, LazyAvlNode *lt, LazyAvlNode *rt, int h = 0, bool del = false )
-        : element{ std::move( ele ) }, left{ lt }, right{ rt }, height{ h }, isDeleted{ del } { }
+        : element{ std::move( ele ) }, left{ lt }, right{ rt }, height{ h }, size{ 1 }, live{ !del }, depths{ 0 },
+          isDeleted{ del } { }
     };
     
+    // Longest root-to-leaf path in an AVL tree. Its height stays below
+    // 1.45 log2( n + 2 ), so 64 levels hold any tree that fits in memory.
+    static const int MAX_PATH = 64;
+    
+    // Queries sorted and answered together by findBatch( )
+    static constexpr size_t BATCH_WINDOW = 65536;
+    
+    // Compact once more than half the nodes are deleted
+    static constexpr double DEFAULT_COMPACTION_THRESHOLD = 0.5;
+
     LazyAvlNode *root;
+    Allocator<LazyAvlNode> pool;
+    mutable long comparisons;   // Key comparisons made so far
+    int liveCount;              // Nodes not marked as deleted
+    int deletedCount;           // Nodes marked as deleted
+    double compactionThreshold; // Fraction of deleted nodes that triggers compact( )
+
+    /**
+     * Three-way compares x with y and counts the key comparisons made.
+     * Returns <0 if x belongs left of y, >0 if right and 0 if equal.
+     */
+    int compare( const Comparable & x, const Comparable & y ) const {
+        return threeWayCompare( x, y, comparisons );
+    }
+
+    /**
+     * As compare( x, y ), given the prefixes of their keys. Only compares
+     * the keys, and counts a key comparison, if the prefixes are equal.
+     */
+    int compare( const Comparable & x, uint64_t xPrefix, const Comparable & y, uint64_t yPrefix ) const {
+        if ( xPrefix != yPrefix )
+            return xPrefix < yPrefix ? -1 : 1;
+        return compare( x, y );
+    }
 
 /******************************************************************************
      Insert Functions
 ******************************************************************************/
 
+    /**
+     * Internal method to walk down the subtree rooted at t towards x.
+     * Pushes the link to each node passed on the way onto path and returns
+     * the link that holds x, or the empty link where x belongs.
+     * Counts one recursive call per level descended, as the recursive
+     * versions of insert and remove did.
+     */
+    LazyAvlNode ** descend( const Comparable & x, LazyAvlNode * & t, int &count,
+                       LazyAvlNode ** path[ ], int &depth ) {
+        LazyAvlNode **link = &t;
+        while ( *link != nullptr ) {
+            int cmp = compare( x, ( *link )->element );
+            if ( cmp == 0 )
+                break;
+            count++;
+            path[ depth++ ] = link;
+            link = ( cmp < 0 ) ? &( *link )->left : &( *link )->right;
+        }
+        return link;
+    }
+    
     /**
      * Internal method to insert into a subtree.
      * x is the item to insert.
      * t is the node that roots the subtree.
      * Set the new root of the subtree.
-     * Counts the number of recursive calls made to insert
+     * Counts number of recursive calls to insert
      */
     void insert( const Comparable & x, LazyAvlNode * & t, int &count ) {
-        if( t == nullptr )
-            t = new LazyAvlNode{ x, nullptr, nullptr };
-        else if( t->element > x ){
-            count ++;
-            insert( x, t->left, count);
-        }
-        else if( t->element < x ){
-            count ++;
-            insert( x, t->right, count);
-        }
-        else {
-            if (!t->isDeleted) {
+        LazyAvlNode **path[ MAX_PATH ];
+        int depth = 0;
+        LazyAvlNode **link = descend( x, t, count, path, depth );
+        
+        if ( *link != nullptr ) { // Merge duplicates
+            if ( !( *link )->isDeleted ) {
                 // Non deleted node exists, merge two nodes
-                t->element.merge(x);
+                ( *link )->element.merge( x );
             }
             else {
                 // Deleted node. Mark as not deleted
                 // Clear acronyms and merge
-                t->isDeleted = false;
-                t->element.clearAcronyms();
-                t->element.merge(x);
+                ( *link )->isDeleted = false;
+                deletedCount--;
+                liveCount++;
+                countLive( *link, path, depth, 1 );
+                ( *link )->element.clearAcronyms( );
+                ( *link )->element.merge( x );
             }
+            return;
         }
-        
-        balance( t );
+        *link = pool.create( x, nullptr, nullptr );
+        liveCount++;
+        rebalance( path, depth );
     }
-
-    void insert( Comparable && x, LazyAvlNode * & t, int &count) {
-        if( t == nullptr )
-            t = new LazyAvlNode{ std::move( x ), nullptr, nullptr };
-        else if( t->element > x ){
-            count ++;
-            insert( std::move( x ), t->left, count );
-        }
-        else if( t->element < x ){
-            count ++;
-            insert( std::move( x ), t->right, count);
-        }
-        else {
-            if (!t->isDeleted) {
+    
+    /**
+     * Internal method to insert into a subtree.
+     * x is the item to insert.
+     * t is the node that roots the subtree.
+     * Set the new root of the subtree.
+     * Counts number of recursive calls to insert
+     */
+    void insert( Comparable && x, LazyAvlNode * & t, int &count)
+    {
+        LazyAvlNode **path[ MAX_PATH ];
+        int depth = 0;
+        LazyAvlNode **link = descend( x, t, count, path, depth );
+        
+        if ( *link != nullptr ) { // Merge duplicates
+            if ( !( *link )->isDeleted ) {
                 // Non deleted node exists, merge two nodes
-                t->element.merge(x);
+                ( *link )->element.merge( std::move( x ) );
             }
             else {
                 // Deleted node. Mark as not deleted
-                // Clear acronyms and merge 
-                t->isDeleted = false;
-                t->element.clearAcronyms();
-                t->element.merge(x);
+                // Clear acronyms and merge
+                ( *link )->isDeleted = false;
+                deletedCount--;
+                liveCount++;
+                countLive( *link, path, depth, 1 );
+                ( *link )->element.clearAcronyms( );
+                ( *link )->element.merge( std::move( x ) );
             }
+            return;
         }
-        
-        balance( t );
+        *link = pool.create( std::move( x ), nullptr, nullptr );
+        liveCount++;
+        rebalance( path, depth );
+    }
+    
+    /**
+     * Internal method to rebalance the nodes on path, from the bottom up.
+     * Above the first node whose height did not change nothing needs
+     * rebalancing, but every node on the path gained one node, so the rest
+     * only have their counts brought up to date.
+     */
+    void rebalance( LazyAvlNode ** path[ ], int depth ) {
+        while ( depth > 0 ) {
+            LazyAvlNode * & t = *path[ --depth ];
+            int oldHeight = t->height;
+            balance( t );
+            if ( t->height == oldHeight )
+                break;
+        }
+        while ( depth > 0 )
+            update( *path[ --depth ] );
     }
-
     
+    /**
+     * Internal method to add change to the live count of node t and of
+     * every node on the path down to it, when t is marked as deleted or
+     * brought back. The shape does not change, so nothing else does.
+     */
+    void countLive( LazyAvlNode *t, LazyAvlNode ** path[ ], int depth, int change ) {
+        t->live += change;
+        while ( depth > 0 )
+            ( *path[ --depth ] )->live += change;
+    }
+
+
 /******************************************************************************
      Remove Functions
 ******************************************************************************/
@@ -305,32 +739,21 @@ private:
      * Internal method to remove from a subtree.
      * x is the item to remove.
      * t is the node that roots the subtree.
-     * Set the new root of the subtree.
+     * Only marks the node as deleted, so the tree does not change shape.
      * Counts the number of recursive calls made
      */
     bool remove( const Comparable & x, LazyAvlNode * & t, int &count) {
-        if( t == nullptr ){
-            return false;   // Item not found; do nothing
-        }
-        if( t->element > x  ){
-            count++;
-            return remove( x, t->left, count );
+        LazyAvlNode **path[ MAX_PATH ];
+        int depth = 0;
+        LazyAvlNode *node = *descend( x, t, count, path, depth );
+        if( node == nullptr || node->isDeleted ){
+            return false;   // Item not found or already marked as deleted
         }
-        else if( t->element < x ){
-            count++;
-            return remove( x, t->right, count );
-        }
-        else
-        {
-            if (!t->isDeleted) {
-                t->isDeleted = true; // Mark as deleted
-                return true;
-            }
-            else { // already marked as deleted
-                return false;
-            }
-        }
-        
+        node->isDeleted = true; // Mark as deleted
+        liveCount--;
+        deletedCount++;
+        countLive( node, path, depth, -1 );
+        return true;
     }
 
 /******************************************************************************
@@ -392,60 +815,44 @@ private:
 
     }    
 
+    /**
+     * Internal method to walk down the subtree rooted at t towards x.
+     * Returns the node with the same key as x, whether or not it is marked
+     * as deleted, or nullptr if there is none.
+     * Counts one recursive call per level descended, as the recursive
+     * versions of find and contains did.
+     */
+    LazyAvlNode* locate ( const Comparable & x, LazyAvlNode * t, int &count) const {
+        while( t != nullptr ) {
+            int cmp = compare( x, t->element );
+            if( cmp == 0 )
+                return t;
+            count ++;
+            t = ( cmp < 0 ) ? t->left : t->right;
+        }
+        return nullptr;
+    }
+    
     /**
      * Internal method to find a node containing the Comparable element 
      * subtree rooted at t
      * x is the item to find.
      * t is the node that roots the subtree.
-     * Set the new root of the subtree.
      * Returns a pointer to the node containing the element
      * If tree does not contain element or element marked as deleted, returns
      * nullptr
      */
     LazyAvlNode* find ( const Comparable & x, LazyAvlNode * t, int &count) const {
-        
-        if (t == nullptr){
-            return nullptr;
-        }
-        else if( t->element > x ){
-            count ++;
-            return find( x, t->left, count );
+        LazyAvlNode *node = locate( x, t, count );
+        if( node != nullptr && !node->isDeleted ) {
+            return node;
         }
-        else if( t->element < x ){
-            count++;
-            return find( x, t->right, count );
-        }
-        else{ // Found a match, return pointer to node
-            if (!t->isDeleted) {
-                return t;
-            }
-            else {
-                return nullptr;
-            }
-        }
-        
+        return nullptr;
     }
     
     LazyAvlNode* find ( const Comparable & x, LazyAvlNode * t ) const {
-        
-        if (t == nullptr){
-            return nullptr;
-        }
-        else if( t->element > x ){
-            return find( x, t->left );
-        }
-        else if( t->element < x ){
-            return find( x, t->right );
-        }
-        else{ // Found a match, return pointer to node
-            if (!t->isDeleted) {
-                return t;
-            }
-            else {
-                return nullptr;
-            }
-        }
-        
+        int count = 0;
+        return find( x, t, count );
     }
     
     /**
@@ -456,23 +863,57 @@ private:
      * Counts the number of recursive calls made
      */
     bool contains( const Comparable & x, LazyAvlNode *t, int &count ) const {
-        if( t == nullptr )
-            return false;
-        else if( t->element > x ){
-            count ++;
-            return contains( x, t->left, count );
-        }
-        else if( t->element < x ){
+        return find( x, t, count ) != nullptr;
+    }
+    
+    /**
+     * Internal method to answer a batch of queries.
+     * order lists the queries, with their prefixes, in sorted order. Each subtree is
+     * handed the run of order that can only be found inside it: the run is
+     * split at the node with one binary search, so queries sharing a path
+     * share the comparisons made along it.
+     * Deleted nodes are walked through but never match.
+     * Counts the number of nodes visited.
+     */
+    void findBatch( const vector<Comparable> & queries, const vector<BatchQuery> & order,
+                    vector<const Comparable *> & results, int & count ) const {
+        struct Run {
+            LazyAvlNode *t;
+            size_t lo, hi;   // order[ lo .. hi ) belongs to subtree t
+        };
+        vector<Run> stack;
+        stack.push_back( { root, 0, order.size( ) } );
+        
+        while ( !stack.empty( ) ) {
+            Run run = stack.back( );
+            stack.pop_back( );
+            LazyAvlNode *t = run.t;
+            if ( t == nullptr || run.lo == run.hi )
+                continue;
             count++;
-            return contains( x, t->right, count );
-        }
-        else{
-            if (!t->isDeleted) { // Non-deleted Match
-                return true;
+            uint64_t prefix = keyPrefix( t->element );
+            
+            // First query in the run not less than t's element
+            size_t lo = run.lo, hi = run.hi;
+            while ( lo < hi ) {
+                size_t mid = lo + ( hi - lo ) / 2;
+                if ( compare( queries[ order[ mid ].index ], order[ mid ].prefix, t->element, prefix ) < 0 )
+                    lo = mid + 1;
+                else
+                    hi = mid;
             }
-            else {
-                return false;
+            
+            // Queries equal to t's element
+            size_t end = lo;
+            while ( end < run.hi &&
+                    compare( queries[ order[ end ].index ], order[ end ].prefix, t->element, prefix ) == 0 ) {
+                if ( !t->isDeleted )
+                    results[ order[ end ].index ] = &t->element;
+                end++;
             }
+            
+            stack.push_back( { t->left, run.lo, lo } );
+            stack.push_back( { t->right, end, run.hi } );
         }
     }
     
@@ -488,33 +929,36 @@ private:
     }
     
     /**
-     * Recursively counts number of nodes in tree
+     * Return the number of nodes in the subtree rooted at t, 0 if nullptr.
      */
-    int countNodes ( LazyAvlNode *t ) const {
-        if (t == nullptr) {
-            return 0;
-        }
-        if (t->left == nullptr && t->right == nullptr) {
-            return 1;
-        }
-        else {
-            return 1 + countNodes(t->left) + countNodes(t->right);
-        }
+    int size( LazyAvlNode *t ) const {
+        return t == nullptr ? 0 : t->size;
     }
-
+    
     /**
-     * Returns sum of the depth of all nodes in tree rooted at t
+     * Return the number of non-deleted nodes in the subtree rooted at t,
+     * 0 if nullptr.
      */
-    int totalDepth( LazyAvlNode *t, int& totald) {
-        
-        if (t == nullptr) {
-            return totald-1;
-        }
-        else {
-            totald++;
-            return totalDepth(t->left, totald) + totalDepth(t->right, totald);
-        }
-        
+    int live( LazyAvlNode *t ) const {
+        return t == nullptr ? 0 : t->live;
+    }
+    
+    /**
+     * Return the sum of the depths of the nodes below t, 0 if nullptr.
+     */
+    int depths( LazyAvlNode *t ) const {
+        return t == nullptr ? 0 : t->depths;
+    }
+    
+    /**
+     * Recomputes the height, size, live count and depths of t from its
+     * children and its own isDeleted flag.
+     */
+    void update( LazyAvlNode *t ) {
+        t->height = max( height( t->left ), height( t->right ) ) + 1;
+        t->size = size( t->left ) + size( t->right ) + 1;
+        t->live = live( t->left ) + live( t->right ) + !t->isDeleted;
+        t->depths = depths( t->left ) + depths( t->right ) + t->size - 1;
     }
     
     int max( int lhs, int rhs ) const {
@@ -541,31 +985,85 @@ private:
     }
 
     
+    /**
+     * Internal method to visit the non-deleted elements of a subtree rooted
+     * at t in sorted order.
+     */
+    template <typename Visitor>
+    void inOrder( LazyAvlNode *t, Visitor & visit ) const {
+        if( t != nullptr )
+        {
+            inOrder( t->left, visit );
+            if( !t->isDeleted )
+                visit( t->element );
+            inOrder( t->right, visit );
+        }
+    }
+    
 /******************************************************************************
      Internal Constructor/Destructor Helper Functions
 ******************************************************************************/
     
     /**
      * Internal method to make subtree empty.
+     * Rotates left children up until the node has none, then frees it and
+     * moves to its right child, so no stack is needed.
      */
     void makeEmpty( LazyAvlNode * & t ) {
-        if( t != nullptr )
+        while( t != nullptr )
         {
-            makeEmpty( t->left );
-            makeEmpty( t->right );
-            delete t;
+            if( t->left != nullptr ) {
+                LazyAvlNode *lt = t->left;
+                t->left = lt->right;
+                lt->right = t;
+                t = lt;
+            }
+            else {
+                LazyAvlNode *rt = t->right;
+                pool.destroy( t );
+                t = rt;
+            }
         }
-        t = nullptr;
     }
     
     /**
-     * Internal method to clone subtree.
+     * Internal method to clone subtree, using an explicit stack of nodes
+     * still to copy and the links their copies go in.
      */
-    LazyAvlNode * clone( LazyAvlNode *t ) const {
-        if( t == nullptr )
+    LazyAvlNode * clone( LazyAvlNode *t ) {
+        LazyAvlNode *copy = nullptr;
+        vector<pair<LazyAvlNode *, LazyAvlNode **>> stack;
+        stack.push_back( make_pair( t, &copy ) );
+        while( !stack.empty( ) ) {
+            LazyAvlNode *src = stack.back( ).first;
+            LazyAvlNode **link = stack.back( ).second;
+            stack.pop_back( );
+            if( src != nullptr ) {
+                *link = pool.create( src->element, nullptr, nullptr, src->height, src->isDeleted );
+                ( *link )->size = src->size;
+                ( *link )->live = src->live;
+                ( *link )->depths = src->depths;
+                stack.push_back( make_pair( src->right, &( *link )->right ) );
+                stack.push_back( make_pair( src->left, &( *link )->left ) );
+            }
+        }
+        return copy;
+    }
+    
+    /**
+     * Internal method to link nodes[ lo..hi ], in sorted order, into a
+     * perfectly balanced subtree. Returns its root.
+     */
+    LazyAvlNode * buildBalanced( vector<LazyAvlNode *> & nodes, int lo, int hi ) {
+        if ( lo > hi )
             return nullptr;
-        else
-            return new LazyAvlNode{ t->element, clone( t->left ), clone( t->right ), t->height };
+        
+        int mid = lo + ( hi - lo ) / 2;
+        LazyAvlNode *t = nodes[ mid ];
+        t->left = buildBalanced( nodes, lo, mid - 1 );
+        t->right = buildBalanced( nodes, mid + 1, hi );
+        update( t );
+        return t;
     }
     // Avl manipulations
 
@@ -595,34 +1093,34 @@ private:
             else
                 doubleWithRightChild( t );
         
-        t->height = max( height( t->left ), height( t->right ) ) + 1;
+        update( t );
     }
     
     /**
      * Rotate binary tree node with left child.
      * For AVL trees, this is a single rotation for case 1.
-     * Update heights, then set new root.
+     * Update heights and counts, then set new root.
      */
     void rotateWithLeftChild( LazyAvlNode * & k2 ) {
         LazyAvlNode *k1 = k2->left;
         k2->left = k1->right;
         k1->right = k2;
-        k2->height = max( height( k2->left ), height( k2->right ) ) + 1;
-        k1->height = max( height( k1->left ), k2->height ) + 1;
+        update( k2 );
+        update( k1 );
         k2 = k1;
     }
     
     /**
      * Rotate binary tree node with right child.
      * For AVL trees, this is a single rotation for case 4.
-     * Update heights, then set new root.
+     * Update heights and counts, then set new root.
      */
     void rotateWithRightChild( LazyAvlNode * & k1 ) {
         LazyAvlNode *k2 = k1->right;
         k1->right = k2->left;
         k2->left = k1;
-        k1->height = max( height( k1->left ), height( k1->right ) ) + 1;
-        k2->height = max( height( k2->right ), k1->height ) + 1;
+        update( k1 );
+        update( k2 );
         k1 = k2;
     }
     
@@ -0,0 +1,54 @@
+#include "MappedFile.h"
+
+/*****************************************************************************
+ Title:             MappedFile.cpp
+ Created on:        October 18, 2026
+ Description:       Implementation of MappedFile class functions
+
+ *****************************************************************************/
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+* Opens filename and maps all of it. An empty file has nothing to map and
+* gives an empty view.
+*/
+MappedFile::MappedFile(const string &filename):bytes(nullptr), length(0), failed(true) {
+    
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        length = static_cast<size_t>(info.st_size);
+        if (length == 0) {
+            failed = false;
+        }
+        else {
+            void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                // The parser reads the file once from start to end
+                madvise(mapped, length, MADV_SEQUENTIAL);
+                bytes = static_cast<const char *>(mapped);
+                failed = false;
+            }
+            else {
+                length = 0;
+            }
+        }
+    }
+    
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (bytes != nullptr) {
+        munmap(const_cast<char *>(bytes), length);
+    }
+}
@@ -0,0 +1,54 @@
+/*****************************************************************************
+ Title:             MappedFile.h
+ Created on:        October 18, 2026
+ Description:       Read-only view of a whole file mapped into memory. The
+                    parser scans the mapped bytes in place, so reading a
+                    database does not copy it through a stream buffer and
+                    per-line strings first.
+
+                    Like an ifstream, a MappedFile that could not be opened
+                    or mapped reports fail() rather than throwing.
+
+ *****************************************************************************/
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+using namespace std;
+
+class MappedFile {
+private:
+    
+    const char *bytes;      // Start of the mapping, or nullptr if none
+    size_t length;          // Size of the file in bytes
+    bool failed;            // True if the file could not be opened or mapped
+    
+public:
+    
+    // Maps filename read-only. Check fail() before using the contents.
+    explicit MappedFile(const string &filename);
+    ~MappedFile();
+    
+    MappedFile(const MappedFile &rhs) = delete;
+    MappedFile &operator= (const MappedFile &rhs) = delete;
+    
+    // True if the file could not be opened or mapped
+    bool fail () const {
+        return failed;
+    }
+    
+    // Returns the contents of the file
+    string_view view () const {
+        return string_view(bytes, length);
+    }
+    
+    // Returns the size of the file in bytes
+    size_t size () const {
+        return length;
+    }
+};
+
+#endif
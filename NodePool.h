@@ -0,0 +1,149 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+/*****************************************************************************
+ Title:             NodePool.h
+ Created on:        October 18, 2026
+ Description:       Node allocators for the tree template classes.
+
+                    NodePool<Node>:
+                    Slab allocator. Nodes are carved out of contiguous
+                    chunks of NODES_PER_CHUNK slots. Destroyed nodes go on a
+                    free list and are reused by later inserts. release()
+                    hands every chunk back in O(chunks) instead of one
+                    delete per node.
+
+                    HeapAllocator<Node>:
+                    Plain new/delete per node. Kept for comparison with the
+                    pooled allocator.
+
+ ****************************************************************************/
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+using namespace std;
+
+// Allocator interface expected by the trees
+//
+// ******************PUBLIC OPERATIONS*********************
+// Node * create( args... )    --> Construct a node from args and return it
+// void destroy( node )        --> Destroy a node and give back its memory
+// void release( )             --> Give back all memory held by the allocator.
+//                                 Every node must already be destroyed,
+//                                 unless bulk_release is true and Node is
+//                                 trivially destructible.
+// bool bulk_release           --> True if release() frees every node at once
+
+template <typename Node>
+class NodePool
+{
+public:
+
+    static const bool bulk_release = true;
+    static const size_t NODES_PER_CHUNK = 512;
+
+    NodePool( ) : free_list{ nullptr }, used{ NODES_PER_CHUNK } { }
+
+    NodePool( const NodePool & rhs ) = delete;
+    NodePool & operator=( const NodePool & rhs ) = delete;
+
+    NodePool( NodePool && rhs )
+    : chunks{ std::move( rhs.chunks ) }, free_list{ rhs.free_list }, used{ rhs.used } {
+        rhs.chunks.clear( );
+        rhs.free_list = nullptr;
+        rhs.used = NODES_PER_CHUNK;
+    }
+
+    NodePool & operator=( NodePool && rhs ) {
+        std::swap( chunks, rhs.chunks );
+        std::swap( free_list, rhs.free_list );
+        std::swap( used, rhs.used );
+        return *this;
+    }
+
+    ~NodePool( ) {
+        release( );
+    }
+
+    /**
+     * Constructs a node in the next free slot
+     */
+    template <typename... Args>
+    Node * create( Args &&... args ) {
+        return new ( allocate( ) ) Node{ std::forward<Args>( args )... };
+    }
+
+    /**
+     * Destroys node n and puts its slot on the free list
+     */
+    void destroy( Node *n ) {
+        n->~Node( );
+        Slot *s = reinterpret_cast<Slot *>( n );
+        s->next = free_list;
+        free_list = s;
+    }
+
+    /**
+     * Frees every chunk held by the pool
+     */
+    void release( ) {
+        for ( Slot *chunk : chunks ) {
+            delete [] chunk;
+        }
+        chunks.clear( );
+        free_list = nullptr;
+        used = NODES_PER_CHUNK;
+    }
+
+private:
+
+    union Slot {
+        Slot *next;
+        typename aligned_storage<sizeof( Node ), alignof( Node )>::type storage;
+    };
+
+    vector<Slot *> chunks;
+    Slot *free_list;
+    size_t used;    // Slots handed out from the newest chunk
+
+    /**
+     * Returns raw memory for one node. Reuses freed slots first, then
+     * carves from the newest chunk, then allocates a new chunk.
+     */
+    void * allocate( ) {
+        if ( free_list != nullptr ) {
+            Slot *s = free_list;
+            free_list = s->next;
+            return s;
+        }
+        if ( used == NODES_PER_CHUNK ) {
+            chunks.push_back( new Slot[ NODES_PER_CHUNK ] );
+            used = 0;
+        }
+        return &chunks.back( )[ used++ ];
+    }
+};
+
+template <typename Node>
+class HeapAllocator
+{
+public:
+
+    static const bool bulk_release = false;
+
+    template <typename... Args>
+    Node * create( Args &&... args ) {
+        return new Node{ std::forward<Args>( args )... };
+    }
+
+    void destroy( Node *n ) {
+        delete n;
+    }
+
+    void release( ) { }
+};
+
+#endif
@@ -0,0 +1,209 @@
+#include "PackedSequence.h"
+
+/*****************************************************************************
+ Title:             PackedSequence.cpp
+ Created on:        October 18, 2026
+ Description:       Implementation of PackedSequence class functions
+
+ *****************************************************************************/
+
+#include <algorithm>
+#include <functional>
+
+// Symbols in code order. Code i is SYMBOLS[i].
+static const char SYMBOLS[] = "'ABCDGHKMNRSTVWY";
+
+/**
+* Returns the 4 bit code of c, or -1 if c is not an IUPAC symbol or '
+*/
+static int symbolCode(char c) {
+    for (int i = 0; i < 16; i++) {
+        if (SYMBOLS[i] == c) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+PackedSequence::PackedSequence(string_view seq):hi(0), lo(0), size(seq.length()) {
+
+    if (seq.length() > MAX_PACKED) {
+        text.reset(new string(seq));
+        return;
+    }
+
+    for (size_t i = 0; i < seq.length(); i++) {
+        int code = symbolCode(seq[i]);
+        if (code < 0) {
+            // Not IUPAC: keep the text form
+            hi = lo = 0;
+            text.reset(new string(seq));
+            return;
+        }
+
+        uint64_t bits = static_cast<uint64_t>(code);
+        if (i < 16) {
+            hi |= bits << (4 * (15 - i));
+        }
+        else {
+            lo |= bits << (4 * (31 - i));
+        }
+    }
+}
+
+PackedSequence PackedSequence::fromWords(uint64_t hi, uint64_t lo, uint32_t size) {
+    PackedSequence seq;
+    seq.hi = hi;
+    seq.lo = lo;
+    seq.size = size;
+    return seq;
+}
+
+PackedSequence::PackedSequence(const PackedSequence &rhs)
+:hi(rhs.hi), lo(rhs.lo), size(rhs.size), text(rhs.text ? new string(*rhs.text) : nullptr) { }
+
+PackedSequence &PackedSequence::operator= (const PackedSequence &rhs){
+    hi = rhs.hi;
+    lo = rhs.lo;
+    size = rhs.size;
+    text.reset(rhs.text ? new string(*rhs.text) : nullptr);
+    return *this;
+}
+
+char PackedSequence::symbolAt(size_t i) const {
+    if (!isPacked()) {
+        return (*text)[i];
+    }
+    uint64_t bits = (i < 16) ? hi >> (4 * (15 - i)) : lo >> (4 * (31 - i));
+    return SYMBOLS[bits & 0xF];
+}
+
+/**
+* Unpacks the sequence into its text form
+*/
+string PackedSequence::toString() const {
+
+    if (!isPacked()) {
+        return *text;
+    }
+
+    string seq(size, ' ');
+    copyText(&seq[0]);
+    return seq;
+}
+
+void PackedSequence::copyText(char *out) const {
+
+    if (!isPacked()) {
+        text->copy(out, size);
+        return;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        uint64_t bits = (i < 16) ? hi >> (4 * (15 - i)) : lo >> (4 * (31 - i));
+        out[i] = SYMBOLS[bits & 0xF];
+    }
+}
+
+/**
+* Compares symbol by symbol, reading packed symbols straight from the words
+*/
+int PackedSequence::compareText(const PackedSequence &right) const {
+
+    if (!isPacked() && !right.isPacked()) {
+        return text->compare(*right.text);
+    }
+
+    size_t common = min<size_t>(size, right.size);
+    for (size_t i = 0; i < common; i++) {
+        char mine = symbolAt(i);
+        char theirs = right.symbolAt(i);
+        if (mine != theirs) {
+            return static_cast<unsigned char>(mine) < static_cast<unsigned char>(theirs) ? -1 : 1;
+        }
+    }
+    return (size > right.size) - (size < right.size);
+}
+
+/**
+* Compares the words under a mask of the prefix's symbols when both are
+* packed, and the symbols one at a time otherwise
+*/
+bool PackedSequence::startsWith(const PackedSequence &prefix) const {
+
+    if (prefix.size > size) {
+        return false;
+    }
+    if (isPacked() && prefix.isPacked()) {
+        size_t highSymbols = min<size_t>(prefix.size, 16);
+        size_t lowSymbols = prefix.size - highSymbols;
+        uint64_t highMask = highSymbols == 0 ? 0 : ~uint64_t(0) << (4 * (16 - highSymbols));
+        uint64_t lowMask = lowSymbols == 0 ? 0 : ~uint64_t(0) << (4 * (16 - lowSymbols));
+        return ((hi ^ prefix.hi) & highMask) == 0 && ((lo ^ prefix.lo) & lowMask) == 0;
+    }
+    for (size_t i = 0; i < prefix.size; i++) {
+        if (symbolAt(i) != prefix.symbolAt(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t PackedSequence::textHash() const {
+    return std::hash<string>()(*text);
+}
+
+/**
+* Packs the first 16 symbols as the high word of a packed sequence would.
+* At the first character that is not a symbol, packs the highest symbol
+* below it and fills the rest of the word with ones, so the prefix is no
+* more than that of any larger sequence; a character below every symbol
+* packs as zeros.
+*/
+uint64_t PackedSequence::textPrefix() const {
+
+    uint64_t word = 0;
+    size_t symbols = min<size_t>(size, 16);
+    for (size_t i = 0; i < symbols; i++) {
+        unsigned char c = (*text)[i];
+        int code = symbolCode(c);
+        if (code < 0) {
+            int below = -1;
+            while (below < 15 && static_cast<unsigned char>(SYMBOLS[below + 1]) < c) {
+                below++;
+            }
+            if (below >= 0) {
+                uint64_t ones = (i == 15) ? 0 : ~uint64_t(0) >> (4 * (i + 1));
+                word |= (static_cast<uint64_t>(below) << (4 * (15 - i))) | ones;
+            }
+            return word;
+        }
+        word |= static_cast<uint64_t>(code) << (4 * (15 - i));
+    }
+    return word;
+}
+
+size_t PackedSequence::length() const {
+    return size;
+}
+
+/**
+* Returns the position of the cut marker. The marker has code 0, which is
+* also the padding after the last symbol, so only the first size symbols
+* are searched.
+*/
+int PackedSequence::cutPosition() const {
+
+    if (!isPacked()) {
+        size_t pos = text->find('\'');
+        return pos == string::npos ? -1 : static_cast<int>(pos);
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        uint64_t bits = (i < 16) ? hi >> (4 * (15 - i)) : lo >> (4 * (31 - i));
+        if ((bits & 0xF) == 0) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
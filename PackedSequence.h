@@ -0,0 +1,162 @@
+/*****************************************************************************
+ Title:             PackedSequence.h
+ Created on:        October 18, 2026
+ Description:       Compact key for a recognition sequence. Each IUPAC symbol
+                    and the ' cut marker is stored in 4 bits, so sites of up
+                    to 32 symbols fit in two 64-bit words and comparing two
+                    keys is an integer compare.
+
+                    Symbol codes follow ASCII order (' < A < B < C ...), and
+                    the first symbol sits in the highest nibble, so comparing
+                    the words and then the lengths orders keys exactly as
+                    comparing their text forms does.
+
+                    Sequences that are too long or contain other characters
+                    keep their text form and are compared as strings.
+
+ *****************************************************************************/
+
+#ifndef PACKEDSEQUENCE_H
+#define PACKEDSEQUENCE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+using namespace std;
+
+class PackedSequence {
+private:
+
+    uint64_t hi;                // Symbols 0-15, first symbol in the top nibble
+    uint64_t lo;                // Symbols 16-31
+    uint32_t size;              // Number of symbols
+    unique_ptr<string> text;    // Text form, only for sequences that cannot be packed
+
+    // Returns symbol i in text form
+    char symbolAt (size_t i) const;
+
+public:
+
+    // Longest sequence that can be packed
+    static const size_t MAX_PACKED = 32;
+
+    // Packs text. Keeps a copy of text if it is too long or not IUPAC.
+    PackedSequence(string_view seq = string_view());
+
+    PackedSequence(const PackedSequence &rhs);
+    PackedSequence(PackedSequence &&rhs) = default;
+    PackedSequence &operator= (const PackedSequence &rhs);
+    PackedSequence &operator= (PackedSequence &&rhs) = default;
+
+    // Returns the sequence in text form
+    string toString () const;
+
+    // Writes the text form to out, which must have room for length() chars
+    void copyText (char *out) const;
+
+    // Returns the number of symbols in the sequence, including the cut marker
+    size_t length () const;
+
+    // Returns the index of the ' cut marker in the text form, or -1 if none
+    int cutPosition () const;
+
+    // True if the sequence is held in packed form
+    bool isPacked () const {
+        return text == nullptr;
+    }
+
+    // The packed words, as stored in a snapshot. Only meaningful if
+    // isPacked().
+    uint64_t highWord () const {
+        return hi;
+    }
+    uint64_t lowWord () const {
+        return lo;
+    }
+
+    // Compares as compare() does when either sequence is not packed,
+    // without building the text form of the packed one
+    int compareText (const PackedSequence &right) const;
+
+    // Rebuilds a packed sequence from the words of one, without unpacking
+    static PackedSequence fromWords (uint64_t hi, uint64_t lo, uint32_t size);
+
+    // Returns <0, 0 or >0 as this sequence is less than, equal to or
+    // greater than right, in the same order as their text forms
+    int compare (const PackedSequence &right) const {
+        if (isPacked() && right.isPacked()) {
+            if (hi != right.hi) {
+                return hi < right.hi ? -1 : 1;
+            }
+            if (lo != right.lo) {
+                return lo < right.lo ? -1 : 1;
+            }
+            return (size > right.size) - (size < right.size);
+        }
+        return compareText(right);
+    }
+
+    bool operator< (const PackedSequence &right) const {
+        return compare(right) < 0;
+    }
+
+    bool operator> (const PackedSequence &right) const {
+        return compare(right) > 0;
+    }
+
+    bool operator== (const PackedSequence &right) const {
+        if (isPacked() && right.isPacked()) {
+            return hi == right.hi && lo == right.lo && size == right.size;
+        }
+        // A packable sequence never equals one that cannot be packed
+        return !isPacked() && !right.isPacked() && *text == *right.text;
+    }
+
+    bool operator!= (const PackedSequence &right) const {
+        return !(*this == right);
+    }
+
+    // True if the first prefix.length() symbols are those of prefix
+    bool startsWith (const PackedSequence &prefix) const;
+
+    // Returns a word that orders sequences by their first 16 symbols: if
+    // a.prefix() < b.prefix() then a < b, and if a.prefix() > b.prefix()
+    // then a > b. Equal prefixes say nothing, so compare() decides. A packed
+    // sequence's prefix is its high word.
+    uint64_t prefix () const {
+        if (!isPacked()) {
+            return textPrefix();
+        }
+        return hi;
+    }
+
+    // Returns a hash of the sequence. Equal sequences hash alike. A packed
+    // sequence mixes its words, so hashing it reads no text.
+    size_t hash () const {
+        if (!isPacked()) {
+            return textHash();
+        }
+        return mix(hi ^ mix(lo + size));
+    }
+
+private:
+
+    // Hash of the text form, for sequences that are not packed
+    size_t textHash () const;
+
+    // Prefix of the text form, for sequences that are not packed
+    uint64_t textPrefix () const;
+
+    // Spreads every bit of x over the whole word (the MurmurHash3 finaliser)
+    static uint64_t mix (uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+};
+
+#endif
@@ -0,0 +1,134 @@
+#include "PerfCounters.h"
+
+/*****************************************************************************
+ Title:             PerfCounters.cpp
+ Created on:        October 18, 2026
+ Description:       Implementation of PerfCounters class functions
+
+ *****************************************************************************/
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+* Event type and config of each counter, in Counter order
+*/
+static const uint32_t EVENT_TYPES[] = {
+    PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE
+};
+static const uint64_t EVENT_CONFIGS[] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+/**
+* Opens one counter for the calling thread and the threads it starts, in
+* user space only. Returns the descriptor, or -1.
+*/
+static int openCounter(uint32_t type, uint64_t config) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+PerfCounters::PerfCounters():wall(0) {
+    for (int c = 0; c < COUNTERS; c++) {
+        values[c] = 0;
+        fds[c] = openCounter(EVENT_TYPES[c], EVENT_CONFIGS[c]);
+        if (fds[c] < 0 && reason.empty()) {
+            reason = string("perf_event_open: ") + strerror(errno);
+        }
+    }
+    if (anyAvailable()) {
+        reason.clear();
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int c = 0; c < COUNTERS; c++) {
+        if (fds[c] >= 0) {
+            close(fds[c]);
+        }
+    }
+}
+
+void PerfCounters::start() {
+    for (int c = 0; c < COUNTERS; c++) {
+        if (fds[c] >= 0) {
+            ioctl(fds[c], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds[c], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    started = chrono::steady_clock::now();
+}
+
+/**
+* Stops the counters and reads them. A counter that only ran for part of
+* the phase, because the hardware was shared, is scaled up to the whole.
+*/
+void PerfCounters::stop() {
+    wall = chrono::steady_clock::now() - started;
+    for (int c = 0; c < COUNTERS; c++) {
+        values[c] = 0;
+        if (fds[c] < 0) {
+            continue;
+        }
+        ioctl(fds[c], PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t data[3];       // Value, time enabled, time running
+        if (read(fds[c], data, sizeof(data)) == static_cast<ssize_t>(sizeof(data)) && data[2] > 0) {
+            values[c] = static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2]);
+        }
+    }
+}
+
+#else
+
+PerfCounters::PerfCounters():reason("hardware counters need Linux perf_event_open"), wall(0) {
+    for (int c = 0; c < COUNTERS; c++) {
+        fds[c] = -1;
+        values[c] = 0;
+    }
+}
+
+PerfCounters::~PerfCounters() { }
+
+void PerfCounters::start() {
+    started = chrono::steady_clock::now();
+}
+
+void PerfCounters::stop() {
+    wall = chrono::steady_clock::now() - started;
+}
+
+#endif
+
+bool PerfCounters::anyAvailable() const {
+    for (int c = 0; c < COUNTERS; c++) {
+        if (fds[c] >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *PerfCounters::name(Counter c) {
+    static const char *NAMES[] = {"Cycles", "Instructions", "L1D read misses", "LLC misses", "Branch misses"};
+    return NAMES[c];
+}
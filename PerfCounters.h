@@ -0,0 +1,83 @@
+/*****************************************************************************
+ Title:             PerfCounters.h
+ Created on:        October 18, 2026
+ Description:       Hardware performance counters for a phase of work, read
+                    through perf_event_open. Counts cycles, instructions, L1
+                    data cache read misses, last level cache misses and
+                    branch misses made in user space by the calling thread
+                    and any threads it starts, along with the wall time.
+
+                    Each counter is opened on its own, so a machine without
+                    one of them still reports the others. Where counters
+                    cannot be opened at all (not Linux, no PMU in a virtual
+                    machine, or perf_event_paranoid forbids it), only the
+                    wall time is measured and error() says why.
+
+                    Like MappedFile, a PerfCounters object reports what it
+                    could not do rather than throwing.
+
+ *****************************************************************************/
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+using namespace std;
+
+class PerfCounters {
+public:
+
+    enum Counter { CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, COUNTERS };
+
+    // Opens every counter the machine allows. Counters start stopped.
+    PerfCounters ();
+    ~PerfCounters ();
+
+    PerfCounters (const PerfCounters &rhs) = delete;
+    PerfCounters &operator= (const PerfCounters &rhs) = delete;
+
+    // Resets the counters and starts counting a phase
+    void start ();
+
+    // Stops counting. Values are read until the next start().
+    void stop ();
+
+    // True if counter c could be opened
+    bool available (Counter c) const {
+        return fds[c] >= 0;
+    }
+
+    // True if any counter could be opened
+    bool anyAvailable () const;
+
+    // Returns the count of c over the last phase, scaled up if the kernel
+    // shared the hardware counter with other events for part of it
+    uint64_t value (Counter c) const {
+        return values[c];
+    }
+
+    // Returns the wall time of the last phase in ms
+    double wallTime () const {
+        return wall.count();
+    }
+
+    // Returns why no counter could be opened, or an empty string
+    const string &error () const {
+        return reason;
+    }
+
+    // Returns the name of c as printed in reports
+    static const char *name (Counter c);
+
+private:
+
+    int fds[COUNTERS];                  // -1 for a counter that is not open
+    uint64_t values[COUNTERS];
+    string reason;
+    chrono::steady_clock::time_point started;
+    chrono::duration<double, milli> wall;
+};
+
+#endif
@@ -11,8 +11,44 @@
  
  *****************************************************************************/
 
-SequenceMap::SequenceMap(string seq, string acronym):sequence(seq) {
-    enzyme_acronyms.insert(acronym);
+#include <algorithm>
+
+SequenceMap::SequenceMap(string_view seq, string_view acronym):sequence(seq) {
+    enzyme_acronyms.insert(AcronymTable::intern(acronym));
+}
+
+SequenceMap::SequenceMap(PackedSequence seq, string_view acronym):sequence(move(seq)) {
+    enzyme_acronyms.insert(AcronymTable::intern(acronym));
+}
+
+SequenceMap::SequenceMap(PackedSequence seq, AcronymSet acronyms)
+:sequence(move(seq)), enzyme_acronyms(move(acronyms)) { }
+
+/**
+* Returns the recognition sequence in text form
+*/
+string SequenceMap::getSequence() const {
+    return sequence.toString();
+}
+
+/**
+* Returns the packed recognition sequence used as the key
+*/
+const PackedSequence &SequenceMap::getKey() const {
+    return sequence;
+}
+
+/**
+* Returns the enzyme acronyms in sorted order
+*/
+vector<string> SequenceMap::getAcronyms() const {
+    vector<string> acronyms;
+    acronyms.reserve(enzyme_acronyms.size());
+    for (uint32_t id: enzyme_acronyms) {
+        acronyms.push_back(string(AcronymTable::name(id)));
+    }
+    sort(acronyms.begin(), acronyms.end());
+    return acronyms;
 }
 
 /**
@@ -26,16 +62,19 @@ void SequenceMap::clearAcronyms(){
 * If two sequence maps contain the same sequence, merge by 
 * combining their two sets of enzyme acronyms
 */
-void SequenceMap::merge(SequenceMap &other){
+void SequenceMap::merge(SequenceMap &&other){
     
     // Check if sequences of both sequences are the same
     if (other.sequence != sequence) {
-        throw logic_error(other.sequence);
+        throw logic_error(other.sequence.toString());
     }
     
-    // Merge: Add other's acronyms to sequence map
-    for (auto s: other.enzyme_acronyms) {
-        enzyme_acronyms.insert(s);
+    // Merge: Take other's acronyms if there are none to add them to
+    if (enzyme_acronyms.size() == 0) {
+        enzyme_acronyms = move(other.enzyme_acronyms);
+    }
+    else {
+        enzyme_acronyms.merge(other.enzyme_acronyms);
     }
     
 }
@@ -44,43 +83,21 @@ void SequenceMap::merge(const SequenceMap &other){
     
     // Check if sequences of both sequences are the same
     if (other.sequence != sequence) {
-        throw logic_error(other.sequence);
+        throw logic_error(other.sequence.toString());
     }
     
     // Merge: Add other's acronyms to sequence map
-    for (auto s: other.enzyme_acronyms) {
-        enzyme_acronyms.insert(s);
-    }
+    enzyme_acronyms.merge(other.enzyme_acronyms);
     
 }
 
-/**
-* Compare two SequenceMaps using their recognition sequence strings
-*/
-bool SequenceMap::operator< (const SequenceMap &right){
-    
-    if (this->sequence < right.sequence) {
-        return true; 
-    }
-    return false;
-}
-
-
-bool SequenceMap::operator> (const SequenceMap &right){
-    
-    if (this->sequence > right.sequence) {
-        return true;
-    }
-    return false;
-}
-
 /**
 * Print the list of enzyme acronyms for the sequence to the console
 */
 ostream &operator << (ostream &os, const SequenceMap &sm){
     
     os << "ACRONYMS: " << endl;
-    for (auto x: sm.enzyme_acronyms) {
+    for (const string &x: sm.getAcronyms()) {
         os << x << endl;
     }
     
@@ -3,9 +3,13 @@
  Author:            Anna Cristina Karingal
  Created on:        February 21, 2015
  Description:       Class for containing a recognition sequence and the set of
-                    enzymes that act on it.
+                    enzymes that act on it. The sequence is stored as a
+                    PackedSequence so comparisons are integer compares, and
+                    the enzymes as ids of interned acronyms.
                     Functions to: 
-                        - compare two SequenceMaps by their sequence strings
+                        - compare two SequenceMaps by their sequence strings,
+                          either three-way with compare() or with < and >,
+                          and check whether one sequence starts with another
                         - merge two SequenceMaps that possess identical
                           sequence strings
                         - print the list of enzyme acronyms for a sequence to
@@ -19,31 +23,72 @@
 #define SEQUENCEMAP_H
 
 #include <iostream>
-#include <set>
 #include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "AcronymTable.h"
+#include "PackedSequence.h"
 using namespace std;
 
 class SequenceMap {
 private:
     
-    string sequence;
-    set <string> enzyme_acronyms;
+    PackedSequence sequence;
+    AcronymSet enzyme_acronyms;
     
 public:
     
-    // Constructor that initializes with an empty set of enzyme acronyms by default
-    SequenceMap(string seq, string acronym="");
+    // Constructor that initializes with an empty acronym by default
+    SequenceMap(string_view seq, string_view acronym = string_view());
+    
+    // Constructor for a sequence that is already packed, as made by the parser
+    SequenceMap(PackedSequence seq, string_view acronym);
     
-    // In case of duplicates: adds other SequenceMap's enzyme acronym to enzyme acronyms
-    void merge(SequenceMap &other);
+    // Constructor for a sequence and a set of interned acronyms, as read
+    // back from a snapshot
+    SequenceMap(PackedSequence seq, AcronymSet acronyms);
+    
+    // In case of duplicates: adds other SequenceMap's enzyme acronym to enzyme acronyms.
+    // The rvalue overload takes other's acronyms over when this map has none.
+    void merge(SequenceMap &&other);
     void merge(const SequenceMap &other);
     
-    // Removes all acronyms existing from enyme_acronyms and creates an empty set
+    // Returns the recognition sequence in text form
+    string getSequence () const;
+    
+    // Returns the packed recognition sequence used as the key
+    const PackedSequence &getKey () const;
+    
+    // Returns the enzyme acronyms in sorted order
+    vector<string> getAcronyms () const;
+    
+    // Returns the ids of the enzyme acronyms in the AcronymTable
+    const AcronymSet &getAcronymIds () const {
+        return enzyme_acronyms;
+    }
+    
+    // Removes all acronyms existing from enyme_acronyms, leaving an empty set
     void clearAcronyms ();
     
-    // Compares SequenceMaps using sequence string as a key
-    bool operator< (const SequenceMap &right);
-    bool operator> (const SequenceMap &right);
+    // Compares SequenceMaps using sequence as a key. Defined here so the
+    // packed compare is inlined into the tree searches.
+    // compare() returns <0, 0 or >0 and lets a tree decide which way to go
+    // with a single key comparison.
+    int compare (const SequenceMap &right) const {
+        return sequence.compare(right.sequence);
+    }
+    bool operator< (const SequenceMap &right) const {
+        return sequence < right.sequence;
+    }
+    bool operator> (const SequenceMap &right) const {
+        return sequence > right.sequence;
+    }
+    
+    // True if the sequence starts with the sequence of prefix
+    bool startsWith (const SequenceMap &prefix) const {
+        return sequence.startsWith(prefix.sequence);
+    }
     
     // Overloaded << operator to print contents of sequence map to console.
     friend ostream &operator << (ostream &os, const SequenceMap &sm);
@@ -0,0 +1,401 @@
+#ifndef SITE_SCANNER_H
+#define SITE_SCANNER_H
+
+/*****************************************************************************
+ Title:             SiteScanner.h
+ Created on:        October 18, 2026
+ Description:       Finds every recognition site of a database in a long DNA
+                    sequence, on both strands, in one pass.
+
+                    Each site and, unless it is a palindrome, its reverse
+                    complement is a pattern of IUPAC symbols. Expanding a
+                    whole pattern into concrete bases can give millions of
+                    strings (NNNNNNN alone is 16384), so only its most
+                    selective window, the one that pins down the most bases
+                    while expanding to at most EXPANSION_LIMIT strings, goes
+                    into an Aho-Corasick automaton over A, C, G and T. When
+                    the automaton finds a window, the whole pattern is
+                    checked against the last bases seen once its last base
+                    has been read.
+
+                    The sequence is given as raw bytes of a FASTA record
+                    body: line breaks are skipped and any byte other than
+                    A, C, G or T (in either case) matches nothing.
+
+ ****************************************************************************/
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "IupacCodes.h"
+#include "SequenceMap.h"
+
+using namespace std;
+
+/**
+ * A match of pattern starting at base position of the scanned text
+ */
+struct SiteHit {
+    long position;
+    int pattern;
+};
+
+// SiteScanner class
+//
+// CONSTRUCTION: from any tree that provides inOrder( visit )
+//
+// ******************PUBLIC OPERATIONS*********************
+// long scan( begin, end, ownEnd, hits ) --> Appends to hits the matches in
+//                                 the text [begin, end) that start before
+//                                 ownEnd, in order. Positions count bases
+//                                 from begin. Returns the number of bases in
+//                                 [begin, ownEnd).
+// int patterns( )             --> Returns the number of patterns
+// const SequenceMap & element( p ) --> Returns the site pattern p comes from
+// char strand( p )            --> '+' if p is a site, '-' if it is the
+//                                 reverse complement of one
+// int longestPattern( )       --> Returns the length of the longest pattern
+// int states( )               --> Returns the number of automaton states
+
+class SiteScanner
+{
+public:
+
+    // Most concrete strings one pattern's window may expand to
+    static const int EXPANSION_LIMIT = 64;
+
+    // Longest pattern scanned for. Longer sites are left out.
+    static const int MAX_PATTERN = 64;
+
+    /**
+     * Compiles the elements of tree into patterns and builds the automaton
+     */
+    template <typename TreeType>
+    explicit SiteScanner( const TreeType & tree ) : longest{ 0 } {
+        tree.inOrder( [this]( const SequenceMap & x ) {
+            // Drop the cut marker and skip sites with other symbols
+            string site;
+            for ( char c : x.getSequence( ) ) {
+                if ( c != '\'' )
+                    site += c;
+            }
+            if ( site.empty( ) || static_cast<int>( site.size( ) ) > MAX_PATTERN )
+                return;
+            for ( char c : site ) {
+                if ( iupacBases( c ) == 0 )
+                    return;
+            }
+
+            string reverse( site.rbegin( ), site.rend( ) );
+            for ( char & c : reverse )
+                c = iupacComplement( c );
+
+            int element = static_cast<int>( elements.size( ) );
+            elements.push_back( x );
+            addPattern( site, '+', element );
+            if ( reverse != site )
+                addPattern( reverse, '-', element );
+        } );
+
+        buildAutomaton( );
+    }
+
+    /**
+     * Scans the text [begin, end) and appends to hits, sorted by position,
+     * every match that starts before the base at ownEnd. Positions count
+     * the bases from begin, starting at 0. Returns the number of bases in
+     * [begin, ownEnd).
+     */
+    long scan( const char * begin, const char * end, const char * ownEnd, vector<SiteHit> & hits ) const {
+        // The last RING bases seen, as masks; the matches waiting to be
+        // checked, by the position of their last base; and the matches
+        // found, by the position of their first base
+        uint8_t ring[ RING ] = { };
+        vector<SiteHit> pending[ RING ];
+        vector<SiteHit> found[ RING ];
+
+        long base = 0;
+        long ownBases = -1;
+        int32_t state = 0;
+
+        for ( const char * p = begin; p < end; p++ ) {
+            if ( p == ownEnd )
+                ownBases = base;
+
+            uint8_t mask = BASE_MASKS[ static_cast<unsigned char>( *p ) ];
+            if ( mask == LINE_BREAK )
+                continue;
+
+            ring[ base & ( RING - 1 ) ] = mask;
+            state = ( mask == 0 ) ? 0 : delta[ state ][ __builtin_ctz( mask ) ];
+
+            // Every window ending here starts a candidate match
+            for ( int32_t s = ( wordCount( state ) > 0 ) ? state : dictionaryLink[ state ]; s >= 0;
+                 s = dictionaryLink[ s ] ) {
+                for ( uint32_t w = firstWord[ s ]; w < firstWord[ s + 1 ]; w++ ) {
+                    long start = base - words[ w ].lastSymbol;
+                    if ( start >= 0 ) {
+                        long last = start + static_cast<long>( masks[ words[ w ].pattern ].size( ) ) - 1;
+                        pending[ last & ( RING - 1 ) ].push_back( { start, words[ w ].pattern } );
+                    }
+                }
+            }
+
+            // Check the candidates whose last base this is
+            vector<SiteHit> & ready = pending[ base & ( RING - 1 ) ];
+            for ( const SiteHit & candidate : ready ) {
+                if ( ( ownBases < 0 || candidate.position < ownBases ) && matchesAt( candidate, ring ) )
+                    found[ candidate.position & ( RING - 1 ) ].push_back( candidate );
+            }
+            ready.clear( );
+
+            // No match starting longest - 1 bases back is still unchecked
+            if ( base >= longest - 1 )
+                emit( found[ ( base - longest + 1 ) & ( RING - 1 ) ], hits );
+            base++;
+        }
+        if ( ownBases < 0 )
+            ownBases = base;
+        for ( long start = max( 0L, base - longest + 1 ); start < base; start++ )
+            emit( found[ start & ( RING - 1 ) ], hits );
+        return ownBases;
+    }
+
+    /**
+     * Returns number of patterns, counting each strand of a site
+     */
+    int patterns( ) const {
+        return static_cast<int>( masks.size( ) );
+    }
+
+    /**
+     * Returns the element pattern p was made from
+     */
+    const SequenceMap & element( int p ) const {
+        return elements[ patternElement[ p ] ];
+    }
+
+    /**
+     * Returns '+' if pattern p is a site as stored, '-' if it is the
+     * reverse complement of one
+     */
+    char strand( int p ) const {
+        return patternStrand[ p ];
+    }
+
+    /**
+     * Returns the length of the longest pattern
+     */
+    int longestPattern( ) const {
+        return longest;
+    }
+
+    /**
+     * Returns number of states in the automaton
+     */
+    int states( ) const {
+        return static_cast<int>( delta.size( ) );
+    }
+
+private:
+
+    // A window of a pattern: pattern, and the position in the pattern of
+    // the last symbol of the window
+    struct Word {
+        int pattern;
+        int lastSymbol;
+    };
+
+    // Size of the ring of recent bases. A power of two above MAX_PATTERN.
+    static const int RING = 128;
+
+    // Mask of a line break in BASE_MASKS; not a set of bases
+    static const uint8_t LINE_BREAK = 0xFF;
+
+    // Bases each byte of text stands for
+    static constexpr array<uint8_t, 256> BASE_MASKS = [] {
+        array<uint8_t, 256> table{ };
+        table[ 'A' ] = table[ 'a' ] = 1;
+        table[ 'C' ] = table[ 'c' ] = 2;
+        table[ 'G' ] = table[ 'g' ] = 4;
+        table[ 'T' ] = table[ 't' ] = 8;
+        table[ '\n' ] = table[ '\r' ] = LINE_BREAK;
+        return table;
+    }( );
+
+    vector<SequenceMap> elements;       // Sites scanned for
+    vector<vector<uint8_t>> masks;      // Bases each symbol of a pattern stands for
+    vector<char> patternStrand;         // '+' or '-' for each pattern
+    vector<int> patternElement;         // Index in elements of each pattern's site
+    int longest;                        // Length of the longest pattern
+
+    // Trie of windows while patterns are added; the automaton afterwards
+    vector<array<int32_t, 4>> delta;    // Next state for each base
+    vector<vector<Word>> stateWords;    // Windows ending at each state, while building
+    vector<uint32_t> firstWord;         // words[ firstWord[ s ] .. firstWord[ s + 1 ] ) end at s
+    vector<Word> words;
+    vector<int32_t> dictionaryLink;     // Nearest suffix state with words, or -1
+
+    /**
+     * Returns the number of windows ending at state s
+     */
+    uint32_t wordCount( int32_t s ) const {
+        return firstWord[ s + 1 ] - firstWord[ s ];
+    }
+
+    /**
+     * Returns true if the pattern of candidate matches the bases in ring
+     * from candidate's position on
+     */
+    bool matchesAt( const SiteHit & candidate, const uint8_t ring[ ] ) const {
+        const vector<uint8_t> & pattern = masks[ candidate.pattern ];
+        for ( size_t i = 0; i < pattern.size( ); i++ ) {
+            if ( !( pattern[ i ] & ring[ ( candidate.position + i ) & ( RING - 1 ) ] ) )
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Appends the matches in bucket, which all start at the same base, to
+     * hits in pattern order, and empties bucket
+     */
+    static void emit( vector<SiteHit> & bucket, vector<SiteHit> & hits ) {
+        if ( bucket.size( ) > 1 ) {
+            sort( bucket.begin( ), bucket.end( ), []( const SiteHit & a, const SiteHit & b ) {
+                return a.pattern < b.pattern;
+            } );
+        }
+        hits.insert( hits.end( ), bucket.begin( ), bucket.end( ) );
+        bucket.clear( );
+    }
+
+    /**
+     * Adds pattern, a string of IUPAC symbols, and adds every concrete
+     * string its window stands for to the trie
+     */
+    void addPattern( const string & pattern, char strand, int element ) {
+        int p = static_cast<int>( masks.size( ) );
+        vector<uint8_t> bases;
+        for ( char c : pattern )
+            bases.push_back( static_cast<uint8_t>( iupacBases( c ) ) );
+        masks.push_back( bases );
+        patternStrand.push_back( strand );
+        patternElement.push_back( element );
+        longest = max( longest, static_cast<int>( pattern.size( ) ) );
+
+        int from, to;
+        chooseWindow( bases, from, to );
+
+        // Walk every expansion of the window, creating trie states
+        if ( delta.empty( ) ) {
+            delta.push_back( emptyState( ) );
+            stateWords.push_back( vector<Word>( ) );
+        }
+        vector<pair<int32_t, int>> stack;     // (state, next window symbol)
+        stack.push_back( make_pair( 0, from ) );
+        while ( !stack.empty( ) ) {
+            int32_t state = stack.back( ).first;
+            int i = stack.back( ).second;
+            stack.pop_back( );
+            if ( i == to ) {
+                stateWords[ state ].push_back( { p, to - 1 } );
+                continue;
+            }
+            for ( int b = 0; b < 4; b++ ) {
+                if ( !( bases[ i ] & ( 1 << b ) ) )
+                    continue;
+                if ( delta[ state ][ b ] < 0 ) {
+                    delta[ state ][ b ] = static_cast<int32_t>( delta.size( ) );
+                    delta.push_back( emptyState( ) );
+                    stateWords.push_back( vector<Word>( ) );
+                }
+                stack.push_back( make_pair( delta[ state ][ b ], i + 1 ) );
+            }
+        }
+    }
+
+    /**
+     * Picks the window [from, to) of bases that carries the most
+     * information, in bits, while expanding to at most EXPANSION_LIMIT
+     * concrete strings
+     */
+    static void chooseWindow( const vector<uint8_t> & bases, int & from, int & to ) {
+        double best = -1;
+        from = 0;
+        to = 1;
+        for ( size_t a = 0; a < bases.size( ); a++ ) {
+            long expansions = 1;
+            double bits = 0;
+            for ( size_t b = a; b < bases.size( ); b++ ) {
+                int choices = __builtin_popcount( bases[ b ] );
+                expansions *= choices;
+                if ( expansions > EXPANSION_LIMIT )
+                    break;
+                bits += 2 - log2( choices );
+                if ( bits > best ) {
+                    best = bits;
+                    from = static_cast<int>( a );
+                    to = static_cast<int>( b + 1 );
+                }
+            }
+        }
+    }
+
+    static array<int32_t, 4> emptyState( ) {
+        array<int32_t, 4> next;
+        next.fill( -1 );
+        return next;
+    }
+
+    /**
+     * Turns the trie into an Aho-Corasick automaton: fills in the missing
+     * transitions from failure links, breadth first, and links each state
+     * to the nearest state on its failure chain that ends a window.
+     */
+    void buildAutomaton( ) {
+        if ( delta.empty( ) ) {
+            delta.push_back( emptyState( ) );
+            stateWords.push_back( vector<Word>( ) );
+        }
+        vector<int32_t> fail( delta.size( ), 0 );
+        dictionaryLink.assign( delta.size( ), -1 );
+
+        vector<int32_t> queue;
+        for ( int b = 0; b < 4; b++ ) {
+            if ( delta[ 0 ][ b ] < 0 )
+                delta[ 0 ][ b ] = 0;
+            else
+                queue.push_back( delta[ 0 ][ b ] );
+        }
+        for ( size_t q = 0; q < queue.size( ); q++ ) {
+            int32_t s = queue[ q ];
+            for ( int b = 0; b < 4; b++ ) {
+                int32_t child = delta[ s ][ b ];
+                if ( child < 0 ) {
+                    delta[ s ][ b ] = delta[ fail[ s ] ][ b ];
+                    continue;
+                }
+                fail[ child ] = delta[ fail[ s ] ][ b ];
+                dictionaryLink[ child ] = stateWords[ fail[ child ] ].empty( )
+                    ? dictionaryLink[ fail[ child ] ] : fail[ child ];
+                queue.push_back( child );
+            }
+        }
+
+        // Flatten the words of each state into one array
+        firstWord.assign( 1, 0 );
+        for ( const vector<Word> & ws : stateWords ) {
+            words.insert( words.end( ), ws.begin( ), ws.end( ) );
+            firstWord.push_back( static_cast<uint32_t>( words.size( ) ) );
+        }
+        stateWords.clear( );
+        stateWords.shrink_to_fit( );
+    }
+};
+
+#endif
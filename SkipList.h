@@ -0,0 +1,671 @@
+#ifndef SKIP_LIST_H
+#define SKIP_LIST_H
+
+/*****************************************************************************
+ Title:             SkipList.h
+ Created on:        October 18, 2026
+ Description:       Template class for a lock-free skip list with the same
+                    interface as the trees, for loads where many threads
+                    write at once.
+
+                    Each node holds a pointer to its element and a tower of
+                    next pointers, one per level, in one allocation with the
+                    element it was inserted with. The low bit of a next
+                    pointer marks the node that holds it as unlinked at
+                    that level, and the low bit of the element pointer marks
+                    the element as removed. Every change is one compare and
+                    swap, so no thread waits for another:
+                        - insert links a new node level by level, bottom
+                          first. Inserting an element that is already there
+                          merges it into a copy of the old element and swaps
+                          the copy in.
+                        - remove marks the element, which is the point at
+                          which it is gone, then marks the tower top down;
+                          whoever walks past a marked node unlinks it.
+                        - contains walks past marked nodes without changing
+                          anything, so it never retries: readers are
+                          wait-free.
+                    A removed node is freed once both its inserter and its
+                    remover are done with it and a last walk has unlinked it
+                    at every level, through epoch-based reclamation (see
+                    EpochReclamation.h) so no thread still walking can be
+                    left holding it. Elements replaced by merges are freed
+                    the same way.
+
+ Sources:           The walks follow the lock-free skip list of Herlihy and
+                    Shavit, as found in The Art of Multiprocessor
+                    Programming, with removal marked on the element as in
+                    Fraser's thesis, Practical Lock-Freedom.
+
+ ****************************************************************************/
+
+#include "EpochReclamation.h"
+#include "ThreeWayCompare.h"
+#include "TreeSnapshot.h"
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+using namespace std;
+
+// SkipList class
+//
+// CONSTRUCTION: zero parameter
+//
+// ******************PUBLIC OPERATIONS*********************
+// Safe from any number of threads at once:
+// void insert( x, count )     --> Insert x, merging it with an equal
+//                                 element. Adds to count the nodes visited.
+// bool remove( x, count )     --> Removes x. Adds to count the nodes
+//                                 visited.
+// bool contains( x, count )   --> Return true if x is present; else false.
+//                                 Adds to count the nodes visited.
+// vector<bool> containsBatch( xs, count )
+//                             --> Result i is true if xs[i] is present.
+//                                 Adds to count the nodes visited.
+// bool find( x, visit )       --> Calls visit( element ) on the element
+//                                 equal to x while it is safe to read, and
+//                                 returns true; else returns false.
+// void printNode( x )         --> Prints element in node containing x
+// boolean isEmpty( )          --> Return true if empty; else false
+// void makeEmpty( )           --> Remove all items
+// long keyComparisons( )      --> Returns the number of key comparisons made
+//                                 by insert, remove, contains and find.
+// With no other thread using the list:
+// int nodes( )                --> Returns the number of elements
+// int internalPathLength( )   --> Returns the sum over all elements of the
+//                                 nodes visited to find each one, so that
+//                                 divided by nodes( ) it is the average
+//                                 search path length.
+// void printTree( )           --> Print list in sorted order
+// bool save( path, shape )    --> Writes the elements to a snapshot file
+//                                 (see TreeSnapshot.h). A skip list has no
+//                                 shape to save, so shape is ignored.
+//                                 Returns false on failure.
+// bool load( path )           --> Replaces the contents with a snapshot.
+//                                 Returns false, leaving the list as it
+//                                 was, if the file is not a valid snapshot.
+// ******************ERRORS********************************
+// Throws CapacityException if too many threads use concurrent containers at
+// once
+
+template <typename Comparable>
+class SkipList
+{
+public:
+
+
+/******************************************************************************
+     PUBLIC CONSTRUCTORS, DESTRUCTORS, MOVERS
+******************************************************************************/
+
+    SkipList( ) : head{ SkipNode::create( MAX_LEVEL ) }, epochs{ new EpochDomain }, comparisons{ 0 } { }
+
+    SkipList( const SkipList & rhs ) = delete;
+    SkipList & operator=( const SkipList & rhs ) = delete;
+
+    // Moves are not safe while other threads use either list
+    SkipList( SkipList && rhs ) : SkipList( ) {
+        *this = std::move( rhs );
+    }
+
+    SkipList & operator=( SkipList && rhs ) {
+        std::swap( head, rhs.head );
+        std::swap( epochs, rhs.epochs );
+        comparisons.store( rhs.comparisons.exchange( comparisons.load( ) ) );
+        return *this;
+    }
+
+    // No thread may be using the list when it is destroyed
+    ~SkipList( ) {
+        clear( );
+        delete head;
+    }
+
+
+/******************************************************************************
+     PUBLIC READ FUNCTIONS
+******************************************************************************/
+
+    /**
+     * Returns true if x is found in the list. Else returns false
+     * Counts the nodes visited
+     */
+    bool contains( const Comparable & x, int & count ) const {
+        EpochDomain::Guard guard( *epochs );
+        long compared = 0;
+        bool found = lookup( x, count, compared ) != nullptr;
+        comparisons.fetch_add( compared, memory_order_relaxed );
+        return found;
+    }
+
+    /**
+     * Returns, for each query, true if it is found in the list. Each query
+     * is its own lookup, so other threads may change the list in between.
+     * Counts the nodes visited
+     */
+    vector<bool> containsBatch( const vector<Comparable> & queries, int & count ) const {
+        vector<bool> results( queries.size( ) );
+        for( size_t i = 0; i < queries.size( ); i++ )
+            results[ i ] = contains( queries[ i ], count );
+        return results;
+    }
+
+    template <typename Visitor>
+    bool find( const Comparable & x, Visitor visit ) const {
+        EpochDomain::Guard guard( *epochs );
+        int count = 0;
+        long compared = 0;
+        SkipNode *t = lookup( x, count, compared );
+        comparisons.fetch_add( compared, memory_order_relaxed );
+        if( t == nullptr )
+            return false;
+        visit( *elementOf( t ) );
+        return true;
+    }
+
+    void printNode( const Comparable & x ) const {
+        if( !find( x, [ ]( const Comparable & element ) { cout << element << endl; } ) )
+            cout << "Element not found in tree." << endl;
+    }
+
+    bool isEmpty( ) const {
+        EpochDomain::Guard guard( *epochs );
+        return firstLive( ) == nullptr;
+    }
+
+    /**
+     * Returns the number of key comparisons made by insert, remove,
+     * contains and find since the list was created
+     */
+    long keyComparisons( ) const {
+        return comparisons.load( );
+    }
+
+    int nodes( ) const {
+        int n = 0;
+        for( SkipNode *t = nextOf( head, 0 ); t != nullptr; t = nextOf( t, 0 ) ) {
+            if( isLive( t ) )
+                n++;
+        }
+        return n;
+    }
+
+    /**
+     * Returns the sum over all elements of the nodes visited by contains( )
+     * to find each one
+     */
+    int internalPathLength( ) const {
+        EpochDomain::Guard guard( *epochs );
+        int total = 0;
+        long compared = 0;
+        for( SkipNode *t = nextOf( head, 0 ); t != nullptr; t = nextOf( t, 0 ) ) {
+            if( isLive( t ) )
+                lookup( *elementOf( t ), total, compared );
+        }
+        return total;
+    }
+
+    void printTree( ) const {
+        if( isEmpty( ) )
+            cout << "Empty tree" << endl;
+        for( SkipNode *t = nextOf( head, 0 ); t != nullptr; t = nextOf( t, 0 ) ) {
+            if( isLive( t ) )
+                cout << *elementOf( t ) << endl;
+        }
+    }
+
+
+/******************************************************************************
+     PUBLIC WRITE FUNCTIONS
+******************************************************************************/
+
+    /**
+     * Insert x into the list; duplicates are merged
+     * Counts the nodes visited
+     */
+    void insert( const Comparable & x, int & count ) {
+        add( x, count );
+    }
+
+    void insert( Comparable && x, int & count ) {
+        add( std::move( x ), count );
+    }
+
+    /**
+     * Remove x from the list. Nothing is done if x is not found.
+     * Counts the nodes visited
+     */
+    bool remove( const Comparable & x, int & count ) {
+        EpochDomain::Guard guard( *epochs );
+        Path path;
+        long compared = 0;
+        bool removed = false;
+        if( search( x, path, count, compared ) ) {
+            SkipNode *t = path.succs[ 0 ];
+            removed = !isMarked( t->element.fetch_or( 1 ) );
+            if( removed ) {
+                markTower( t );
+                release( t, count, compared );
+            }
+        }
+        comparisons.fetch_add( compared, memory_order_relaxed );
+        return removed;
+    }
+
+    /**
+     * Removes every element, one at a time from the front, so other threads
+     * may keep using the list
+     */
+    void makeEmpty( ) {
+        EpochDomain::Guard guard( *epochs );
+        int count = 0;
+        for( SkipNode *t = firstLive( ); t != nullptr; t = firstLive( ) )
+            remove( *elementOf( t ), count );
+    }
+
+
+/******************************************************************************
+     PUBLIC SNAPSHOT FUNCTIONS
+******************************************************************************/
+
+    /**
+     * Writes the elements to a snapshot file at path in sorted order.
+     * Returns false if the file could not be written.
+     */
+    bool save( const string & path, bool /*shape*/ = true ) const {
+        SnapshotWriter writer( false );
+        for( SkipNode *t = nextOf( head, 0 ); t != nullptr; t = nextOf( t, 0 ) ) {
+            if( isLive( t ) )
+                writer.add( *elementOf( t ), 0 );
+        }
+        return writer.write( path );
+    }
+
+    /**
+     * Replaces the contents of the list with the snapshot at path. Nodes
+     * are appended in sorted order at every level, so no keys are compared.
+     * Returns false, leaving the list unchanged, if path is not a valid
+     * snapshot.
+     */
+    bool load( const string & path ) {
+        SnapshotReader reader( path );
+        if( reader.fail( ) )
+            return false;
+
+        clear( );
+        SkipNode *last[ MAX_LEVEL ];
+        for( SkipNode * & t : last )
+            t = head;
+        for( size_t i = 0; i < reader.size( ); i++ ) {
+            SkipNode *t = SkipNode::create( randomHeight( ), reader.element( i ) );
+            t->owners.store( 1 );
+            for( int level = 0; level < t->height; level++ ) {
+                last[ level ]->next( )[ level ].store( address( t ) );
+                last[ level ] = t;
+            }
+        }
+        return true;
+    }
+
+
+private:
+
+/*****************************************************************************
+     Member Data
+*****************************************************************************/
+
+    // With half the nodes of each level reaching the next, 32 levels keep
+    // searches logarithmic well past any list that fits in memory
+    static const int MAX_LEVEL = 32;
+
+    /**
+     * A node, its first element and its tower of next pointers, allocated
+     * together so a search reads the key next to the pointers it follows.
+     * Elements merged in later are copies on the heap.
+     */
+    struct SkipNode
+    {
+        atomic<uintptr_t> element;  // Comparable *, low bit set once removed
+        atomic<int> owners;         // Of the inserter and remover, those
+                                    // not yet done with the node
+        short height;
+        bool inlined;               // False only for the head
+
+        SkipNode( int h, bool i ) : element{ 0 }, owners{ 2 }, height( h ), inlined{ i } { }
+
+        ~SkipNode( ) {
+            Comparable *e = elementOf( this );
+            if( e != item( ) )
+                delete e;
+            if( inlined )
+                item( )->~Comparable( );
+        }
+
+        /**
+         * Returns a node of the given height holding an element made from
+         * args, or no element if there are none
+         */
+        template <typename... Args>
+        static SkipNode * create( int height, Args &&... args ) {
+            void *memory = ::operator new( towerOffset( ) + height * sizeof( atomic<uintptr_t> ) );
+            SkipNode *t = new( memory ) SkipNode{ height, sizeof...( Args ) > 0 };
+            if constexpr( sizeof...( Args ) > 0 ) {
+                new( t->item( ) ) Comparable( std::forward<Args>( args )... );
+                t->element.store( reinterpret_cast<uintptr_t>( t->item( ) ) );
+            }
+            for( int level = 0; level < height; level++ )
+                new( &t->next( )[ level ] ) atomic<uintptr_t>{ 0 };
+            return t;
+        }
+
+        static void operator delete( void *memory ) {
+            ::operator delete( memory );
+        }
+
+        // The first element, which follows the node in memory
+        Comparable * item( ) {
+            return reinterpret_cast<Comparable *>( reinterpret_cast<char *>( this ) + itemOffset( ) );
+        }
+
+        // The tower, which follows the first element. Low bit set once the
+        // node is unlinked at that level.
+        atomic<uintptr_t> * next( ) {
+            return reinterpret_cast<atomic<uintptr_t> *>( reinterpret_cast<char *>( this ) + towerOffset( ) );
+        }
+
+        static size_t itemOffset( ) {
+            return roundUp( sizeof( SkipNode ), alignof( Comparable ) );
+        }
+
+        static size_t towerOffset( ) {
+            return roundUp( itemOffset( ) + sizeof( Comparable ), alignof( atomic<uintptr_t> ) );
+        }
+
+        static size_t roundUp( size_t size, size_t alignment ) {
+            return ( size + alignment - 1 ) / alignment * alignment;
+        }
+    };
+
+    // The nodes before and after a key at every level
+    struct Path
+    {
+        SkipNode *preds[ MAX_LEVEL ];
+        SkipNode *succs[ MAX_LEVEL ];
+    };
+
+    SkipNode *head;                 // Tower of MAX_LEVEL, with no element
+    unique_ptr<EpochDomain> epochs;
+    mutable atomic<long> comparisons;   // Key comparisons made so far
+
+
+/******************************************************************************
+     MARKED POINTERS
+******************************************************************************/
+
+    static bool isMarked( uintptr_t p ) {
+        return ( p & 1 ) != 0;
+    }
+
+    static uintptr_t address( SkipNode *t ) {
+        return reinterpret_cast<uintptr_t>( t );
+    }
+
+    static SkipNode * nodeAt( uintptr_t p ) {
+        return reinterpret_cast<SkipNode *>( p & ~uintptr_t{ 1 } );
+    }
+
+    static Comparable * elementOf( SkipNode *t ) {
+        return reinterpret_cast<Comparable *>( t->element.load( ) & ~uintptr_t{ 1 } );
+    }
+
+    static SkipNode * nextOf( SkipNode *t, int level ) {
+        return nodeAt( t->next( )[ level ].load( ) );
+    }
+
+    static bool isLive( SkipNode *t ) {
+        return !isMarked( t->element.load( ) );
+    }
+
+
+/******************************************************************************
+     PRIVATE READ FUNCTIONS
+******************************************************************************/
+
+    /**
+     * Three-way compares x with the element of t and counts the node
+     */
+    int compare( const Comparable & x, SkipNode *t, int & count, long & compared ) const {
+        count++;
+        return threeWayCompare( x, *elementOf( t ), compared );
+    }
+
+    /**
+     * Returns the node holding x if x is present, else nullptr. Steps over
+     * nodes unlinked at the level it walks, but changes nothing. A node is
+     * compared once even if it is met again on a lower level.
+     */
+    SkipNode * lookup( const Comparable & x, int & count, long & compared ) const {
+        SkipNode *pred = head;
+        SkipNode *last = nullptr;
+        int lastOrder = 0;
+        for( int level = MAX_LEVEL - 1; level >= 0; level-- ) {
+            SkipNode *curr = nextOf( pred, level );
+            while( curr != nullptr ) {
+                uintptr_t succ = curr->next( )[ level ].load( );
+                if( isMarked( succ ) ) {
+                    curr = nodeAt( succ );
+                    continue;
+                }
+                int order = ( curr == last ) ? lastOrder : compare( x, curr, count, compared );
+                last = curr;
+                lastOrder = order;
+                if( order == 0 )
+                    return isLive( curr ) ? curr : nullptr;
+                if( order < 0 )
+                    break;
+                pred = curr;
+                curr = nodeAt( succ );
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * Returns the first node whose element is not removed, or nullptr
+     */
+    SkipNode * firstLive( ) const {
+        SkipNode *t = nextOf( head, 0 );
+        while( t != nullptr && !isLive( t ) )
+            t = nextOf( t, 0 );
+        return t;
+    }
+
+
+/******************************************************************************
+     PRIVATE WRITE FUNCTIONS
+******************************************************************************/
+
+    /**
+     * Fills path with the last node before x and the first node not before
+     * it at every level, unlinking the marked nodes it passes. Returns true
+     * if the first node not before x on the bottom level holds x.
+     */
+    bool search( const Comparable & x, Path & path, int & count, long & compared ) {
+        bool found = false;
+        while( !trySearch( x, path, count, compared, found ) ) { }
+        return found;
+    }
+
+    /**
+     * One attempt at search( ). Returns false if another thread changed a
+     * node before it could unlink a marked one, so the walk must start over.
+     */
+    bool trySearch( const Comparable & x, Path & path, int & count, long & compared, bool & found ) {
+        SkipNode *pred = head;
+        SkipNode *last = nullptr;
+        int lastOrder = 0;
+        for( int level = MAX_LEVEL - 1; level >= 0; level-- ) {
+            SkipNode *curr = nextOf( pred, level );
+            int order = 1;
+            while( curr != nullptr ) {
+                uintptr_t succ = curr->next( )[ level ].load( );
+                if( isMarked( succ ) ) {
+                    uintptr_t expected = address( curr );
+                    if( !pred->next( )[ level ].compare_exchange_strong( expected, succ & ~uintptr_t{ 1 } ) )
+                        return false;
+                    curr = nodeAt( succ );
+                    continue;
+                }
+                order = ( curr == last ) ? lastOrder : compare( x, curr, count, compared );
+                last = curr;
+                lastOrder = order;
+                if( order <= 0 )
+                    break;
+                pred = curr;
+                curr = nodeAt( succ );
+            }
+            path.preds[ level ] = pred;
+            path.succs[ level ] = curr;
+            found = curr != nullptr && order == 0;
+        }
+        return true;
+    }
+
+    /**
+     * Inserts x, merging it with an equal element. x is moved into a new
+     * node if it is an rvalue.
+     * Counts the nodes visited
+     */
+    template <typename Element>
+    void add( Element && x, int & count ) {
+        EpochDomain::Guard guard( *epochs );
+        Path path;
+        long compared = 0;
+        SkipNode *fresh = nullptr;
+        bool linked = false;
+        while( !linked ) {
+            // Once x is in a node, the node's element stands in for it
+            const Comparable & key = ( fresh == nullptr ) ? x : *fresh->item( );
+            if( search( key, path, count, compared ) ) {
+                if( merge( path.succs[ 0 ], key ) )
+                    break;
+                // The equal element was being removed; it is unlinked now
+                continue;
+            }
+            if( fresh == nullptr )
+                fresh = SkipNode::create( randomHeight( ), std::forward<Element>( x ) );
+            for( int level = 0; level < fresh->height; level++ )
+                fresh->next( )[ level ].store( address( path.succs[ level ] ) );
+            uintptr_t expected = address( path.succs[ 0 ] );
+            linked = path.preds[ 0 ]->next( )[ 0 ].compare_exchange_strong( expected, address( fresh ) );
+        }
+
+        if( linked ) {
+            linkTower( fresh, path, count, compared );
+            release( fresh, count, compared );
+        }
+        else
+            delete fresh;
+        comparisons.fetch_add( compared, memory_order_relaxed );
+    }
+
+    /**
+     * Links t, already linked on the bottom level, into the levels above.
+     * Stops if t is marked for removal, as the remover will unlink it.
+     */
+    void linkTower( SkipNode *t, Path & path, int & count, long & compared ) {
+        for( int level = 1; level < t->height; level++ ) {
+            for( ; ; ) {
+                uintptr_t next = t->next( )[ level ].load( );
+                uintptr_t succ = address( path.succs[ level ] );
+                if( isMarked( next ) )
+                    return;
+                if( next != succ && !t->next( )[ level ].compare_exchange_strong( next, succ ) )
+                    return;
+                if( path.preds[ level ]->next( )[ level ].compare_exchange_strong( succ, address( t ) ) )
+                    break;
+                search( *elementOf( t ), path, count, compared );
+                if( path.succs[ 0 ] != t )
+                    return;
+            }
+        }
+    }
+
+    /**
+     * Merges x into a copy of t's element and swaps the copy in. Returns
+     * false, after helping the remover, if t's element has been removed.
+     */
+    bool merge( SkipNode *t, const Comparable & x ) {
+        uintptr_t old = t->element.load( );
+        for( ; ; ) {
+            if( isMarked( old ) ) {
+                markTower( t );
+                return false;
+            }
+            Comparable *merged = new Comparable{ *reinterpret_cast<Comparable *>( old ) };
+            merged->merge( x );
+            if( t->element.compare_exchange_strong( old, reinterpret_cast<uintptr_t>( merged ) ) ) {
+                // The first element goes with the node
+                if( reinterpret_cast<Comparable *>( old ) != t->item( ) )
+                    epochs->retire( reinterpret_cast<Comparable *>( old ) );
+                return true;
+            }
+            delete merged;
+        }
+    }
+
+    /**
+     * Marks every level of t, top down, so no node can be linked after it
+     */
+    void markTower( SkipNode *t ) {
+        for( int level = t->height - 1; level >= 0; level-- )
+            t->next( )[ level ].fetch_or( 1 );
+    }
+
+    /**
+     * Lets go of t for its inserter or remover. The last to let go walks to
+     * t once more, unlinking it at every level, and retires it.
+     */
+    void release( SkipNode *t, int & count, long & compared ) {
+        if( t->owners.fetch_sub( 1 ) == 1 ) {
+            Path path;
+            search( *elementOf( t ), path, count, compared );
+            epochs->retire( t );
+        }
+    }
+
+    /**
+     * Returns a height with probability 1/2 of each level above the first
+     */
+    static int randomHeight( ) {
+        thread_local uint64_t state = 0x9E3779B97F4A7C15ull * ( ReaderThreads::index( ) + 1 );
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        int height = 1;
+        for( uint64_t bits = state; ( bits & 1 ) != 0 && height < MAX_LEVEL; bits >>= 1 )
+            height++;
+        return height;
+    }
+
+    /**
+     * Frees every node. No other thread may be using the list.
+     */
+    void clear( ) {
+        SkipNode *t = nextOf( head, 0 );
+        while( t != nullptr ) {
+            SkipNode *next = nextOf( t, 0 );
+            delete t;
+            t = next;
+        }
+        for( int level = 0; level < MAX_LEVEL; level++ )
+            head->next( )[ level ].store( 0 );
+    }
+};
+
+#endif
@@ -10,18 +10,58 @@
                         - Displays the average depth of all nodes in tree
                         - Displays ratio of average depth to log base 2 of n
 
-                    searchFromFile (filename, tree) : 
+                    searchFromFile (filename, tree, batch) : 
                     Searches the tree for sequences listed in filename and
-                    prints the number of sequences found and the number of
-                    recursive calls made to contains().
+                    prints the number of sequences found, the number of
+                    recursive calls made to contains() and the number of key
+                    comparisons made. Then searches again for the sequences
+                    found and for those not found, and prints the average
+                    time of a hit and of a miss. With batch, answers all the
+                    sequences with one call to containsBatch() and prints
+                    the number of nodes visited instead.
 
                     removeAlternateSequences (filename, tree):
                     Removes every other sequence in in filename from tree and
-                    prints the number of sequences removed and the number of
-                    recursive calls made to remove().
+                    prints the number of sequences removed, the number of
+                    recursive calls made to remove() and the number of key
+                    comparisons made.
 
-                    runTestRoutines(tree, filename: 
-                    Runs all the above tests.
+                    runTestRoutines(tree, filename, batch, perf): 
+                    Runs all the above tests. With perf, also prints the
+                    hardware counters of each search and of the removes.
+
+                    measureOpenTree (file, filename, threads, snapshot,
+                    perf):
+                    Opens a tree as openTree() does, counting the work in
+                    perf if it is not nullptr.
+
+                    printPhaseCounters (phase, perf, operations, unit):
+                    Prints the wall time and hardware counters of a phase
+                    measured in perf, in total and per operation.
+
+                    reportCompaction (tree):
+                    Prints the live and deleted node counts and the average
+                    depth of a tree with lazy deletion before and after
+                    compacting it.
+
+                    compareBuildTimes (filename):
+                    Times building a tree from filename one insert at a time
+                    and, if the tree supports it, by bulk loading. Counts
+                    the recursive calls made to insert() and the heap
+                    allocations made by parsing and by each build, and
+                    prints the heap bytes held by the tree built one insert
+                    at a time.
+
+                    compareParallelBuildTimes (filename, threads):
+                    Times parsing and building a tree from filename with 1,
+                    2, 4, ... up to threads threads and prints the speedup
+                    over one thread.
+
+                    compareSearches (first, first_name, second,
+                    second_name, filename):
+                    Searches two trees for the sequences in filename and
+                    prints side by side the average depth, search time,
+                    nodes visited and key comparisons of each.
 
  
  Last Modified:     March 8, 2015
@@ -38,8 +78,14 @@
 #include <string>
 #include <iomanip>
 #include <cmath>
+#include <chrono>
+#include <vector>
 
+#include "AllocationCounter.h"
+#include "MappedFile.h"
+#include "PerfCounters.h"
 #include "SequenceMap.h"
+#include "TreeParser.h"
 
 using namespace std;
 
@@ -49,7 +95,7 @@ using namespace std;
 * the sequences in the search file.
 */
 template <typename TreeType>
-void runTestRoutine(TreeType &tree, string filename){
+void runTestRoutine(TreeType &tree, string filename, bool batch = false, PerfCounters *perf = nullptr){
     
     // Print number of nodes, avg depth & avg depth ratio
     getTreeCharacteristics(tree);
@@ -57,13 +103,13 @@ void runTestRoutine(TreeType &tree, string filename){
     cout << "--------------------" << endl;
     cout << "..Searching tree for sequences in file...\n" << endl;
     // Search tree for sequences in a given query file
-    searchFromFile(filename, tree);
+    searchFromFile(filename, tree, batch, perf, "search");
     
     cout << "--------------------" << endl;
     cout << "...Removing every other sequence from tree...\n" << endl;
 
     // Remove every other sequence in query file from tree
-    removeAlternateSequences(filename, tree);
+    removeAlternateSequences(filename, tree, perf);
     
     
     cout << "--------------------" << endl;
@@ -73,8 +119,212 @@ void runTestRoutine(TreeType &tree, string filename){
     cout << "--------------------" << endl;
     cout << "...Searching tree for sequences in file...\n" << endl;
     // Search new tree for sequences in file
-    searchFromFile(filename, tree);
+    searchFromFile(filename, tree, batch, perf, "search after remove");
+    
+}
+
+/**
+* Prints the wall time and the hardware counters of the last phase measured
+* in perf, in total and per operation. Counters that could not be opened
+* are left out; if none could be, says why. Does nothing if perf is nullptr.
+*/
+inline void printPhaseCounters(const string &phase, const PerfCounters *perf, size_t operations, const string &unit) {
     
+    if (perf == nullptr) {
+        return;
+    }
+    
+    double per = (operations == 0) ? 0.0 : 1.0 / operations;
+    cout << "Hardware counters, " << phase << " (" << operations << " operations):" << endl;
+    cout << "    Wall time (ms): " << perf->wallTime() << " (" << perf->wallTime() * 1e6 * per
+         << " ns per " << unit << ")" << endl;
+    
+    if (!perf->anyAvailable()) {
+        cout << "    Counters not available: " << perf->error() << endl;
+        return;
+    }
+    
+    for (int c = 0; c < PerfCounters::COUNTERS; c++) {
+        PerfCounters::Counter counter = static_cast<PerfCounters::Counter>(c);
+        if (perf->available(counter)) {
+            cout << "    " << PerfCounters::name(counter) << ": " << perf->value(counter) << " ("
+                 << perf->value(counter) * per << " per " << unit << ")" << endl;
+        }
+    }
+    if (perf->available(PerfCounters::CYCLES) && perf->available(PerfCounters::INSTRUCTIONS) &&
+        perf->value(PerfCounters::CYCLES) > 0) {
+        cout << "    Instructions per cycle: "
+             << static_cast<double>(perf->value(PerfCounters::INSTRUCTIONS)) / perf->value(PerfCounters::CYCLES) << endl;
+    }
+}
+
+/**
+* Opens a tree of type TreeType as openTree() does and, if perf is not
+* nullptr, counts the work in it as one phase
+*/
+template <typename TreeType>
+TreeType measureOpenTree(const MappedFile &file, const string &filename, int threads, const string &snapshot,
+                         PerfCounters *perf) {
+    
+    if (perf != nullptr) {
+        perf->start();
+    }
+    TreeType tree = openTree<TreeType>(file, filename, threads, snapshot);
+    if (perf != nullptr) {
+        perf->stop();
+    }
+    return tree;
+}
+
+/**
+* Returns the number of (recognition sequence, enzyme) pairs in file
+*/
+inline size_t countSequences(const MappedFile &file) {
+    size_t pairs = 0;
+    scanSequenceMaps(file.view(), [&pairs](string_view, string_view) { pairs++; });
+    return pairs;
+}
+
+/**
+* Prints the number of live and deleted nodes and the average depth of a tree
+* with lazy deletion
+*/
+template <typename TreeType>
+void printTombstones(TreeType &tree) {
+    
+    cout << "Live nodes: " << tree.liveNodes() << endl;
+    cout << "Deleted nodes: " << tree.deletedNodes() << endl;
+    if (!tree.isEmpty()) {
+        cout << "Average Depth: " << static_cast<float>(tree.internalPathLength()) / tree.nodes() << endl;
+    }
+}
+
+/**
+* Shows the live and deleted node counts and average depth of a tree with lazy
+* deletion, compacts the tree, and shows them again
+*/
+template <typename TreeType>
+void reportCompaction(TreeType &tree) {
+    
+    printTombstones(tree);
+    
+    cout << "--------------------" << endl;
+    cout << "...Compacting tree...\n" << endl;
+    tree.compact();
+    
+    printTombstones(tree);
+}
+
+/**
+* Prints the number of heap allocations made by a step of building a tree,
+* and the number per sequence
+*/
+inline void printAllocations(const string &step, long allocations, size_t sequences) {
+    cout << "Heap allocations in " << step << ": " << allocations << " ("
+         << (sequences == 0 ? 0.0 : static_cast<double>(allocations) / sequences)
+         << " per sequence)" << endl;
+}
+
+/**
+* Times bulk loading a tree of type TreeType from smaps and prints the time.
+* Does nothing for trees that do not support bulk loading
+*/
+template <typename TreeType>
+void printBulkLoadTime(vector<SequenceMap> &smaps, true_type) {
+    
+    long allocations = heapAllocations();
+    auto start = chrono::steady_clock::now();
+    TreeType bulk_tree;
+    bulk_tree.bulkLoad(make_move_iterator(smaps.begin()), make_move_iterator(smaps.end()));
+    chrono::duration<double, milli> bulk_time = chrono::steady_clock::now() - start;
+    allocations = heapAllocations() - allocations;
+    
+    cout << "Build time, bulk load (ms): " << bulk_time.count() << endl;
+    printAllocations("bulk load", allocations, smaps.size());
+}
+
+template <typename TreeType>
+void printBulkLoadTime(vector<SequenceMap> &, false_type) { }
+
+/**
+* Times building a tree of type TreeType from the sequences in a given
+* database file, excluding file I/O. Prints the time taken to insert one
+* sequence at a time and, for trees that support it, the time taken to bulk
+* load the same sequences
+* Counts number of recursive calls made to insert() when inserting one
+* sequence at a time
+*/
+template <typename TreeType>
+void compareBuildTimes(string filename, int &count) {
+    
+    MappedFile readf(filename);
+    
+    if (readf.fail()){
+        cerr << "ERROR: Invalid file. Please check your file name and try again." << endl;
+        exit(-1);
+    }
+    
+    long allocations = heapAllocations();
+    vector<SequenceMap> smaps = readSequenceMaps(readf);
+    printAllocations("parsing", heapAllocations() - allocations, smaps.size());
+    vector<SequenceMap> bulk_smaps = smaps;
+    
+    // The sequences move into the tree, so the bytes they hold are counted
+    // as the tree's once the emptied vector is freed
+    size_t sequences = smaps.size();
+    size_t bytes = heapBytesInUse() - smaps.capacity() * sizeof(SequenceMap);
+    allocations = heapAllocations();
+    auto start = chrono::steady_clock::now();
+    TreeType insert_tree;
+    insertSequenceMaps(insert_tree, smaps, count);
+    chrono::duration<double, milli> insert_time = chrono::steady_clock::now() - start;
+    allocations = heapAllocations() - allocations;
+    vector<SequenceMap>().swap(smaps);
+    bytes = heapBytesInUse() - bytes;
+    
+    cout << "Build time, one insert at a time (ms): " << insert_time.count() << endl;
+    cout << "Key comparisons in insert(): " << insert_tree.keyComparisons() << endl;
+    printAllocations("insert()", allocations, sequences);
+    cout << "Heap bytes held by the tree: " << bytes << " ("
+         << (sequences == 0 ? 0.0 : static_cast<double>(bytes) / sequences) << " per sequence)" << endl;
+    
+    printBulkLoadTime<TreeType>(bulk_smaps, integral_constant<bool, SupportsBulkLoad<TreeType>::value>());
+}
+
+/**
+* Times parsing a given database file and building a tree of type TreeType
+* from it with parseTreeParallel(), for 1, 2, 4, ... threads up to and
+* including max_threads. Prints each time and its speedup over one thread
+*/
+template <typename TreeType>
+void compareParallelBuildTimes(string filename, int max_threads) {
+    
+    MappedFile readf(filename);
+    
+    if (readf.fail()){
+        cerr << "ERROR: Invalid file. Please check your file name and try again." << endl;
+        exit(-1);
+    }
+    
+    vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+    
+    double one_thread_time = 0;
+    for (int threads : thread_counts) {
+        
+        auto start = chrono::steady_clock::now();
+        TreeType tree = parseTreeParallel<TreeType>(readf, threads);
+        chrono::duration<double, milli> build_time = chrono::steady_clock::now() - start;
+        
+        if (threads == 1) {
+            one_thread_time = build_time.count();
+        }
+        cout << "Parallel build time, " << threads << " thread(s) (ms): " << build_time.count()
+             << " (speedup " << one_thread_time / build_time.count() << ")" << endl;
+    }
 }
 
 /**
@@ -94,7 +344,7 @@ void getTreeCharacteristics(TreeType &tree) {
         cout << "Number of Nodes: " << n << endl;
         
         // Compute and print average depth of tree
-        float avg_depth = tree.internalPathLength() / n;
+        float avg_depth = static_cast<float>(tree.internalPathLength()) / n;
         cout << "Average Depth: " << avg_depth << endl;
         
         if (n > 1) {
@@ -113,13 +363,51 @@ void getTreeCharacteristics(TreeType &tree) {
     
 }
 
+/**
+* Returns the average time in ns that tree takes to search for each of
+* queries, or 0 if there are none
+*/
+template <typename TreeType>
+double searchTime(TreeType &tree, const vector<SequenceMap> &queries) {
+    
+    if (queries.empty()) {
+        return 0;
+    }
+    int recursive_calls = 0;
+    auto start = chrono::steady_clock::now();
+    for (const SequenceMap &q : queries) {
+        tree.contains(q, recursive_calls);
+    }
+    chrono::duration<double, nano> search_time = chrono::steady_clock::now() - start;
+    return search_time.count() / queries.size();
+}
+
+/**
+* Prints the average time of a search for one of queries, labelled with
+* kind, or n/a if there are none
+*/
+template <typename TreeType>
+void printSearchTime(const string &kind, TreeType &tree, const vector<SequenceMap> &queries) {
+    
+    cout << "Search time per " << kind << " (ns): ";
+    if (queries.empty()) {
+        cout << "n/a" << endl;
+    }
+    else {
+        cout << searchTime(tree, queries) << endl;
+    }
+}
+
 /**
 * Searches tree for sequences in the given file. 
 * Counts and prints the number of sequences found in the tree
-* and the number of recursive calls made to contains()
+* and the number of recursive calls made to contains(), or with batch, the
+* number of nodes visited by containsBatch()
+* With perf, also prints the hardware counters of the searches as phase
 */
 template <typename TreeType>
-void searchFromFile (string filename, TreeType &tree) {
+void searchFromFile (string filename, TreeType &tree, bool batch = false, PerfCounters *perf = nullptr,
+                     const string &phase = "search") {
     
     ifstream readf;
     readf.open(filename.c_str());
@@ -129,31 +417,131 @@ void searchFromFile (string filename, TreeType &tree) {
         exit(-1);
     }
     
-    int success = 0;
-    int recursive_calls = 0;
+    vector<SequenceMap> queries;
     string query;
     
     if (readf.is_open()) {
         while (getline(readf,query)){
-            SequenceMap q(query);
-            if (tree.contains(q, recursive_calls)){
+            queries.push_back(SequenceMap(query));
+        }
+    }
+    
+    int success = 0;
+    int recursive_calls = 0;
+    long comparisons = tree.keyComparisons();
+    vector<bool> found(queries.size());
+    
+    if (perf != nullptr) {
+        perf->start();
+    }
+    auto start = chrono::steady_clock::now();
+    if (batch) {
+        for (bool hit : tree.containsBatch(queries, recursive_calls)) {
+            if (hit) {
+                success ++;
+            }
+        }
+    }
+    else {
+        for (size_t i = 0; i < queries.size(); i++) {
+            if (tree.contains(queries[i], recursive_calls)){
                 success ++;
+                found[i] = true;
             }
         }
     }
+    chrono::duration<double, milli> search_time = chrono::steady_clock::now() - start;
+    if (perf != nullptr) {
+        perf->stop();
+    }
     
     cout << "Successful queries: " << success << endl;
-    cout << "Recursive calls to contains(): " << recursive_calls << endl;
+    if (batch) {
+        cout << "Nodes visited by containsBatch(): " << recursive_calls << endl;
+    }
+    else {
+        cout << "Recursive calls to contains(): " << recursive_calls << endl;
+    }
+    cout << "Key comparisons in contains(): " << tree.keyComparisons() - comparisons << endl;
+    cout << "Search time (ms): " << search_time.count() << endl;
+    if (!batch) {
+        // Split the queries outside the timed search, so its time and
+        // counters are of the searches alone
+        vector<SequenceMap> hits;
+        vector<SequenceMap> misses;
+        for (size_t i = 0; i < queries.size(); i++) {
+            (found[i] ? hits : misses).push_back(queries[i]);
+        }
+        printSearchTime("hit", tree, hits);
+        printSearchTime("miss", tree, misses);
+    }
+    printPhaseCounters(phase, perf, queries.size(), "query");
+    
+}
+
+/**
+* Searches tree for every query and prints its average depth, the search
+* time and the nodes visited and key comparisons per query, labelled with
+* name
+*/
+template <typename TreeType>
+void printSearchCosts(const string &name, TreeType &tree, const vector<SequenceMap> &queries) {
+    
+    int success = 0;
+    int visited = 0;
+    long comparisons = tree.keyComparisons();
+    
+    auto start = chrono::steady_clock::now();
+    for (const SequenceMap &q : queries) {
+        if (tree.contains(q, visited)) {
+            success ++;
+        }
+    }
+    chrono::duration<double, milli> search_time = chrono::steady_clock::now() - start;
+    comparisons = tree.keyComparisons() - comparisons;
+    
+    double per = queries.empty() ? 0.0 : 1.0 / queries.size();
+    cout << name << ": average depth " << (tree.isEmpty() ? 0.0f : static_cast<float>(tree.internalPathLength()) / tree.nodes())
+         << ", search time (ms) " << search_time.count()
+         << ", found " << success
+         << ", nodes visited per query " << visited * per
+         << ", key comparisons per query " << comparisons * per << endl;
+}
+
+/**
+* Searches two trees holding the same sequences for the sequences in a given
+* file, and prints the cost of each side by side
+*/
+template <typename FirstType, typename SecondType>
+void compareSearches(FirstType &first, const string &first_name, SecondType &second, const string &second_name,
+                     string filename) {
     
+    ifstream readf;
+    readf.open(filename.c_str());
+    
+    if (readf.fail()){
+        cerr << "ERROR: Invalid file. Please check your file name and try again." << endl;
+        exit(-1);
+    }
+    
+    vector<SequenceMap> queries;
+    string query;
+    while (getline(readf,query)){
+        queries.push_back(SequenceMap(query));
+    }
+    
+    printSearchCosts(first_name, first, queries);
+    printSearchCosts(second_name, second, queries);
 }
 
 /**
 * Removes every other sequence in a given file from the tree
 * Counts and prints the number of sequences removed
 * and the number of recursive calls made to remove()
+* With perf, also prints the hardware counters of the removes
 */
 template <typename TreeType>
-void removeAlternateSequences(string filename, TreeType &tree) {
+void removeAlternateSequences(string filename, TreeType &tree, PerfCounters *perf = nullptr) {
     
     ifstream readf;
     readf.open(filename.c_str());
@@ -163,8 +551,7 @@ void removeAlternateSequences(string filename, TreeType &tree) {
         exit(-1);
     }
     
-    int success = 0;
-    int recursive_calls = 0;
+    vector<SequenceMap> removals;
     int query_count = 0;
     string query;
     
@@ -176,16 +563,31 @@ void removeAlternateSequences(string filename, TreeType &tree) {
             
             // Only remove every other query sequence
             if (query_count % 2 == 0 ) {
-                SequenceMap q(query);
-                if (tree.remove(q,recursive_calls)){
-                    success ++;
-                }
+                removals.push_back(SequenceMap(query));
             }
         }
     }
     
+    int success = 0;
+    int recursive_calls = 0;
+    long comparisons = tree.keyComparisons();
+    
+    if (perf != nullptr) {
+        perf->start();
+    }
+    for (const SequenceMap &q : removals) {
+        if (tree.remove(q,recursive_calls)){
+            success ++;
+        }
+    }
+    if (perf != nullptr) {
+        perf->stop();
+    }
+    
     cout << "Successful removes: " << success << endl;
     cout << "Recursive calls to remove(): " << recursive_calls << endl;
+    cout << "Key comparisons in remove(): " << tree.keyComparisons() - comparisons << endl;
+    printPhaseCounters("remove", perf, removals.size(), "remove");
 
 }
 #endif
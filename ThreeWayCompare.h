@@ -0,0 +1,43 @@
+#ifndef THREE_WAY_COMPARE_H
+#define THREE_WAY_COMPARE_H
+
+/*****************************************************************************
+ Title:             ThreeWayCompare.h
+ Created on:        October 18, 2026
+ Description:       threeWayCompare(lhs, rhs, comparisons):
+                    Returns a negative number, zero or a positive number as
+                    lhs is less than, equal to or greater than rhs. Uses
+                    lhs.compare(rhs) when Comparable has one, so each call
+                    costs one key comparison. Otherwise falls back to one or
+                    two calls to operator<.
+                    Adds the number of key comparisons made to comparisons.
+
+ ****************************************************************************/
+
+using namespace std;
+
+template <typename Comparable>
+auto threeWayCompare( const Comparable & lhs, const Comparable & rhs, long & comparisons, int )
+    -> decltype( lhs.compare( rhs ) ) {
+    comparisons++;
+    return lhs.compare( rhs );
+}
+
+template <typename Comparable>
+int threeWayCompare( const Comparable & lhs, const Comparable & rhs, long & comparisons, long ) {
+    comparisons++;
+    if( lhs < rhs )
+        return -1;
+    comparisons++;
+    if( rhs < lhs )
+        return 1;
+    return 0;
+}
+
+template <typename Comparable>
+int threeWayCompare( const Comparable & lhs, const Comparable & rhs, long & comparisons ) {
+    // The literal 0 prefers the compare() overload when it exists
+    return threeWayCompare( lhs, rhs, comparisons, 0 );
+}
+
+#endif
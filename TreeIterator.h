@@ -0,0 +1,175 @@
+#ifndef TREE_ITERATOR_H
+#define TREE_ITERATOR_H
+
+/*****************************************************************************
+ Title:             TreeIterator.h
+ Created on:        October 18, 2026
+ Description:       In-order iterator over the binary trees, and the range
+                    of elements between two iterators.
+
+                    TreeIterator<Node, Comparable>:
+                    Forward iterator over the elements of a tree of Node,
+                    with element, left and right. It keeps a stack of the
+                    nodes still to come whose left subtrees are done, the
+                    next node on top, so it never holds more than one path
+                    of the tree and never copies an element. Moving to the
+                    next element pops the top and pushes the left spine of
+                    its right subtree, so walking k elements costs O(k)
+                    after the O(log n) start, in a balanced tree.
+
+                    An iterator starts at the first node, in sorted order,
+                    whose element satisfies a predicate that is false for a
+                    run of the smallest elements and true for the rest, as
+                    "not less than x" is. One walk down from the root finds
+                    it, which gives lowerBound, upperBound and the end of
+                    a prefix range alike.
+
+                    Nodes with an isDeleted flag, as in LazyAvlTree, are
+                    skipped.
+
+                    TreeRange<Iterator>:
+                    The elements from one iterator up to another, for use
+                    in a range-based for loop.
+
+ ****************************************************************************/
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+using namespace std;
+
+/**
+ * True if node t is a tombstone. Uses t->isDeleted when Node has one; the
+ * literal 0 prefers that overload, as in threeWayCompare( ).
+ */
+template <typename Node>
+auto isTombstone( const Node *t, int ) -> decltype( bool( t->isDeleted ) ) {
+    return t->isDeleted;
+}
+
+template <typename Node>
+bool isTombstone( const Node *, long ) {
+    return false;
+}
+
+template <typename Node, typename Comparable>
+class TreeIterator
+{
+public:
+
+    typedef forward_iterator_tag iterator_category;
+    typedef Comparable value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const Comparable * pointer;
+    typedef const Comparable & reference;
+
+    /**
+     * The end of every tree
+     */
+    TreeIterator( ) { }
+
+    /**
+     * Starts at the first element of the tree rooted at root for which
+     * at( element ) is true, or at the end if there is none. at must be
+     * false for the elements before that one and true for all after it.
+     */
+    template <typename Predicate>
+    TreeIterator( const Node *root, Predicate at ) {
+        const Node *t = root;
+        while( t != nullptr ) {
+            if( at( t->element ) ) {
+                stack.push_back( t );
+                t = t->left;
+            }
+            else
+                t = t->right;
+        }
+        skipTombstones( );
+    }
+
+    /**
+     * The iterator must not be at the end. Checked unless NDEBUG is
+     * defined.
+     */
+    reference operator*( ) const {
+        assert( !stack.empty( ) );
+        return stack.back( )->element;
+    }
+
+    pointer operator->( ) const {
+        assert( !stack.empty( ) );
+        return &stack.back( )->element;
+    }
+
+    TreeIterator & operator++( ) {
+        assert( !stack.empty( ) );
+        advance( );
+        skipTombstones( );
+        return *this;
+    }
+
+    TreeIterator operator++( int ) {
+        TreeIterator old = *this;
+        ++*this;
+        return old;
+    }
+
+    bool operator==( const TreeIterator & rhs ) const {
+        return current( ) == rhs.current( );
+    }
+
+    bool operator!=( const TreeIterator & rhs ) const {
+        return !( *this == rhs );
+    }
+
+private:
+
+    vector<const Node *> stack;     // Nodes still to come, the next on top
+
+    const Node * current( ) const {
+        return stack.empty( ) ? nullptr : stack.back( );
+    }
+
+    /**
+     * Pops the current node and pushes the left spine of its right subtree
+     */
+    void advance( ) {
+        const Node *t = stack.back( );
+        stack.pop_back( );
+        for( t = t->right; t != nullptr; t = t->left )
+            stack.push_back( t );
+    }
+
+    void skipTombstones( ) {
+        while( !stack.empty( ) && isTombstone( stack.back( ), 0 ) )
+            advance( );
+    }
+};
+
+template <typename Iterator>
+class TreeRange
+{
+public:
+
+    TreeRange( Iterator first, Iterator last ) : first{ first }, last{ last } { }
+
+    Iterator begin( ) const {
+        return first;
+    }
+
+    Iterator end( ) const {
+        return last;
+    }
+
+    bool empty( ) const {
+        return first == last;
+    }
+
+private:
+
+    Iterator first;
+    Iterator last;
+};
+
+#endif
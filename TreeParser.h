@@ -9,12 +9,30 @@
                     Parses filename, a file containing a list of enzymes and
                     the recognition sequences they act on. Creates a tree of
                     type TreeType that contains the recognition sequences and
-                    the enzymes that act on them.
+                    the enzymes that act on them. Trees that provide
+                    bulkLoad() are built in one pass. Accepts either a stream
+                    or a MappedFile, which is scanned in place.
+
+                    parseTreeParallel(filename, threads):
+                    As parseTree, but parses line-aligned chunks of a
+                    MappedFile on several threads. Each thread sorts its
+                    sequences and merges duplicates, and the sorted runs are
+                    merged into one stream that builds the tree.
+
+                    openTree(filename, threads, snapshot):
+                    As parseTreeParallel, but loads the tree from a binary
+                    snapshot (see TreeSnapshot.h) if one at least as new as
+                    filename exists, and otherwise writes one after parsing.
+
+                    parseTreeByInsert(filename):
+                    As parseTree, but always inserts one sequence at a time.
 
                     printSequenceMap(tree):
                     Prompts the user for a recognition sequence and searches
                     the tree for that sequence. Prints enzymes that act on
-                    the sequence to the console.
+                    the sequence to the console. A sequence ending in *
+                    lists every sequence that starts with the rest, with
+                    its enzymes, for trees that provide prefix().
  
  Last Modified:     March 8, 2015
  
@@ -27,51 +45,172 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <cstring>
+#include <iterator>
+#include <algorithm>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <sys/stat.h>
 
+#include "MappedFile.h"
 #include "SequenceMap.h"
 
 using namespace std;
 
 /**
- * Parses file and returns a tree of type TreeType containing data in file
- * Counts number of times insert() function is recursively called on the tree
+ * Scans buffer, the contents of a file of enzymes and recognition sequences,
+ * without copying it. Calls visit(sequence, acronym) with views into buffer
+ * for each (recognition sequence, enzyme) pair, in the order they appear.
+ * Header lines, blank lines and lines that do not end in a double slash
+ * are skipped, as are empty sequences.
  */
-template <typename TreeType>
-TreeType parseTree(istream &readf, int &count) {
+template <typename Visit>
+void scanSequenceMaps(string_view buffer, Visit visit) {
     
-    TreeType tree;
-    string line;
+    const char *p = buffer.data();
+    const char *end = p + buffer.size();
     
-    // For each line in file
-    while (getline(readf, line)) {
+    while (p < end) {
         
-        istringstream seqmapss(line);
-        size_t last_letter = line.length() - 1;
+        // Find end of line
+        const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        if (eol == nullptr) {
+            eol = end;
+        }
+        string_view line(p, eol - p);
+        p = eol + 1;
         
-        if (line[last_letter] == '/' && line[last_letter-1] == '/') {
-            
-            // Split line into acronym and recognition sequences
-            string enzyme_acronym;
-            string all_seqs;
-            getline(seqmapss, enzyme_acronym, '/');
-            getline(seqmapss, all_seqs, '\n');
-            
-            // Get the next recognition sequence
-            istringstream seqss(all_seqs);
-            string s;
-            while (getline(seqss, s, '/')){
-                if (!s.empty()){
-                    SequenceMap smap(s, enzyme_acronym);
-
-                    // Insert into tree
-                    tree.insert(smap, count);
-                }
-            }
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
         }
-        else {
+        
+        size_t len = line.length();
+        if (len < 2 || line[len-1] != '/' || line[len-2] != '/') {
             //  Header: Line doesn't end in double slash. Do nothing.
+            continue;
+        }
+        
+        // Split line into acronym and recognition sequences
+        size_t slash = line.find('/');
+        string_view enzyme_acronym = line.substr(0, slash);
+        
+        while (slash < len) {
+            size_t next = line.find('/', slash + 1);
+            if (next == string_view::npos) {
+                next = len;
+            }
+            if (next > slash + 1) {
+                visit(line.substr(slash + 1, next - slash - 1), enzyme_acronym);
+            }
+            slash = next;
         }
     }
+}
+
+/**
+ * Reads a file of enzymes and recognition sequences. Returns one SequenceMap
+ * per (recognition sequence, enzyme) pair, in the order they appear in file.
+ * Each line is read into the same buffer and scanned in place, so sequences
+ * and acronyms are built straight from views into it.
+ */
+inline vector<SequenceMap> readSequenceMaps(istream &readf) {
+    
+    vector<SequenceMap> smaps;
+    string line;
+    
+    // For each line in file
+    while (getline(readf, line)) {
+        scanSequenceMaps(line, [&smaps](string_view seq, string_view acronym) {
+            smaps.emplace_back(seq, acronym);
+        });
+    }
+    
+    return smaps;
+}
+
+/**
+ * Reads a mapped file of enzymes and recognition sequences. Returns one
+ * SequenceMap per (recognition sequence, enzyme) pair, in the order they
+ * appear in file. Sequences are packed and acronyms interned straight from
+ * the mapped bytes, without copying them into strings.
+ */
+inline vector<SequenceMap> readSequenceMaps(const MappedFile &file) {
+    
+    vector<SequenceMap> smaps;
+    scanSequenceMaps(file.view(), [&smaps](string_view seq, string_view acronym) {
+        smaps.emplace_back(PackedSequence(seq), acronym);
+    });
+    
+    return smaps;
+}
+
+/**
+ * True if TreeType has a bulkLoad(first, last) member taking move iterators
+ * over a vector<SequenceMap>
+ */
+template <typename TreeType>
+class SupportsBulkLoad {
+    typedef move_iterator<vector<SequenceMap>::iterator> MoveIt;
+    
+    template <typename T>
+    static auto test(int) -> decltype(declval<T&>().bulkLoad(declval<MoveIt>(), declval<MoveIt>()), true_type());
+    
+    template <typename T>
+    static false_type test(...);
+    
+public:
+    static const bool value = decltype(test<TreeType>(0))::value;
+};
+
+/**
+ * Inserts smaps into tree one at a time, moving each into its node. Leaves
+ * smaps holding moved-from elements.
+ * Counts number of times insert() function is recursively called on the tree
+ */
+template <typename TreeType>
+void insertSequenceMaps(TreeType &tree, vector<SequenceMap> &smaps, int &count) {
+    for (SequenceMap &smap : smaps) {
+        tree.insert(move(smap), count);
+    }
+}
+
+/**
+ * Builds tree from smaps. Trees with a bulkLoad() are built in one pass,
+ * which makes no calls to insert(). Other trees insert one at a time.
+ */
+template <typename TreeType>
+void buildTree(TreeType &tree, vector<SequenceMap> &smaps, int &, true_type) {
+    tree.bulkLoad(make_move_iterator(smaps.begin()), make_move_iterator(smaps.end()));
+}
+
+template <typename TreeType>
+void buildTree(TreeType &tree, vector<SequenceMap> &smaps, int &count, false_type) {
+    insertSequenceMaps(tree, smaps, count);
+}
+
+/**
+ * Parses file and returns a tree of type TreeType containing data in file
+ * Counts number of times insert() function is recursively called on the tree
+ */
+template <typename TreeType>
+TreeType parseTree(istream &readf, int &count) {
+    
+    TreeType tree;
+    vector<SequenceMap> smaps = readSequenceMaps(readf);
+    buildTree(tree, smaps, count, integral_constant<bool, SupportsBulkLoad<TreeType>::value>());
+    
+    return tree;
+}
+
+template <typename TreeType>
+TreeType parseTree(const MappedFile &file, int &count) {
+    
+    TreeType tree;
+    vector<SequenceMap> smaps = readSequenceMaps(file);
+    buildTree(tree, smaps, count, integral_constant<bool, SupportsBulkLoad<TreeType>::value>());
     
     return tree;
 }
@@ -82,47 +221,307 @@ TreeType parseTree(istream &readf, int &count) {
 template <typename TreeType>
 TreeType parseTree(istream &readf) {
     
-    TreeType tree;
-    string line;
+    int count = 0;
+    return parseTree<TreeType>(readf, count);
+}
+
+template <typename TreeType>
+TreeType parseTree(const MappedFile &file) {
     
     int count = 0;
-    // For each line in file
-    while (getline(readf, line)) {
-        
-        istringstream seqmapss(line);
-        size_t last_letter = line.length() - 1;
+    return parseTree<TreeType>(file, count);
+}
+
+/**
+ * A SequenceMap and the offset in the file of the first site that has its
+ * sequence
+ */
+struct PositionedSequenceMap {
+    size_t position;
+    SequenceMap smap;
+};
+
+/**
+ * Splits buffer into at most parts pieces of roughly equal size. Every piece
+ * but the last ends just after a newline, so no line is split.
+ */
+inline vector<string_view> splitLines(string_view buffer, int parts) {
+    
+    vector<string_view> chunks;
+    size_t start = 0;
+    
+    for (int i = 1; i <= parts && start < buffer.size(); i++) {
+        size_t end = buffer.size();
+        if (i < parts) {
+            end = buffer.find('\n', max(start, buffer.size() / parts * i));
+            end = (end == string_view::npos) ? buffer.size() : end + 1;
+        }
+        chunks.push_back(buffer.substr(start, end - start));
+        start = end;
+    }
+    
+    return chunks;
+}
+
+/**
+ * Scans chunk, a piece of file, and returns its SequenceMaps sorted by
+ * sequence with duplicates merged. Each keeps the position of its first site.
+ * The acronyms of the chunk are interned together, so threads parsing other
+ * chunks wait on the acronym table once per chunk, not once per site.
+ */
+inline vector<PositionedSequenceMap> readSortedSequenceMaps(string_view file, string_view chunk) {
+    
+    vector<string_view> sequences;
+    vector<string_view> acronyms;
+    scanSequenceMaps(chunk, [&sequences, &acronyms](string_view seq, string_view acronym) {
+        sequences.push_back(seq);
+        acronyms.push_back(acronym);
+    });
+    vector<uint32_t> ids;
+    AcronymTable::intern(acronyms, ids);
+    
+    vector<PositionedSequenceMap> smaps;
+    smaps.reserve(sequences.size());
+    for (size_t i = 0; i < sequences.size(); i++) {
+        AcronymSet set;
+        set.insert(ids[i]);
+        smaps.push_back({static_cast<size_t>(sequences[i].data() - file.data()),
+                         SequenceMap(PackedSequence(sequences[i]), move(set))});
+    }
+    
+    // Stable, so the first of each run of duplicates is the first in file
+    stable_sort(smaps.begin(), smaps.end(), [](const PositionedSequenceMap &a, const PositionedSequenceMap &b) {
+        return a.smap < b.smap;
+    });
+    
+    size_t unique = 0;
+    for (size_t i = 0; i < smaps.size(); i++) {
+        if (unique > 0 && smaps[unique-1].smap.compare(smaps[i].smap) == 0) {
+            smaps[unique-1].smap.merge(move(smaps[i].smap));
+        }
+        else {
+            if (unique != i) {
+                smaps[unique] = move(smaps[i]);
+            }
+            unique++;
+        }
+    }
+    smaps.erase(smaps.begin() + unique, smaps.end());
+    
+    return smaps;
+}
+
+/**
+ * Merges runs, each sorted with no duplicates, into one sorted run with no
+ * duplicates. Runs hold consecutive chunks of the file, so the earliest run
+ * holding a sequence has its first position.
+ */
+inline vector<PositionedSequenceMap> mergeSortedRuns(vector<vector<PositionedSequenceMap>> &runs) {
+    
+    vector<PositionedSequenceMap> merged;
+    size_t total = 0;
+    for (const auto &run : runs) {
+        total += run.size();
+    }
+    merged.reserve(total);
+    
+    vector<size_t> next(runs.size(), 0);
+    while (true) {
         
-        if (line[last_letter] == '/' && line[last_letter-1] == '/') {
-            
-            // Split line into acronym and recognition sequences
-            string enzyme_acronym;
-            string all_seqs;
-            getline(seqmapss, enzyme_acronym, '/');
-            getline(seqmapss, all_seqs, '\n');
-            
-            // Get the next recognition sequence
-            istringstream seqss(all_seqs);
-            string s;
-            while (getline(seqss, s, '/')){
-                if (!s.empty()){
-                    SequenceMap smap(s, enzyme_acronym);
-                    // Insert into tree
-                    tree.insert(smap, count);
-                }
+        // Find the earliest run with the smallest next sequence
+        int smallest = -1;
+        for (size_t r = 0; r < runs.size(); r++) {
+            if (next[r] < runs[r].size() &&
+                (smallest < 0 || runs[r][next[r]].smap < runs[smallest][next[smallest]].smap)) {
+                smallest = static_cast<int>(r);
             }
         }
-        else {
-            //  Header: Line doesn't end in double slash. Do nothing.
+        if (smallest < 0) {
+            break;
         }
+        
+        merged.push_back(move(runs[smallest][next[smallest]++]));
+        
+        // Merge the same sequence from later runs
+        for (size_t r = smallest + 1; r < runs.size(); r++) {
+            if (next[r] < runs[r].size() && runs[r][next[r]].smap.compare(merged.back().smap) == 0) {
+                merged.back().smap.merge(move(runs[r][next[r]++].smap));
+            }
+        }
+    }
+    
+    return merged;
+}
+
+/**
+ * Builds tree from merged, sorted by sequence with no duplicates. Trees with
+ * a bulkLoad() take the sorted stream as is. Other trees insert in order of
+ * first appearance in file, which gives the same tree as parseTree().
+ */
+template <typename TreeType>
+void buildTree(TreeType &tree, vector<PositionedSequenceMap> &merged, int &count, true_type) {
+    
+    vector<SequenceMap> smaps;
+    smaps.reserve(merged.size());
+    for (PositionedSequenceMap &p : merged) {
+        smaps.push_back(move(p.smap));
+    }
+    buildTree(tree, smaps, count, true_type());
+}
+
+template <typename TreeType>
+void buildTree(TreeType &tree, vector<PositionedSequenceMap> &merged, int &count, false_type) {
+    
+    sort(merged.begin(), merged.end(), [](const PositionedSequenceMap &a, const PositionedSequenceMap &b) {
+        return a.position < b.position;
+    });
+    for (PositionedSequenceMap &p : merged) {
+        tree.insert(move(p.smap), count);
+    }
+}
+
+/**
+ * Parses file on the given number of threads and returns a tree of type
+ * TreeType containing data in file. With threads less than 1, parses on the
+ * calling thread exactly as parseTree() does.
+ * Counts number of times insert() function is recursively called on the tree
+ */
+template <typename TreeType>
+TreeType parseTreeParallel(const MappedFile &file, int threads, int &count) {
+    
+    if (threads < 1) {
+        return parseTree<TreeType>(file, count);
     }
     
+    vector<string_view> chunks = splitLines(file.view(), threads);
+    vector<vector<PositionedSequenceMap>> runs(chunks.size());
+    
+    // The calling thread parses the first chunk
+    vector<thread> workers;
+    for (size_t i = 1; i < chunks.size(); i++) {
+        workers.push_back(thread([&runs, &chunks, &file, i]() {
+            runs[i] = readSortedSequenceMaps(file.view(), chunks[i]);
+        }));
+    }
+    if (!chunks.empty()) {
+        runs[0] = readSortedSequenceMaps(file.view(), chunks[0]);
+    }
+    for (thread &worker : workers) {
+        worker.join();
+    }
+    
+    TreeType tree;
+    vector<PositionedSequenceMap> merged = mergeSortedRuns(runs);
+    buildTree(tree, merged, count, integral_constant<bool, SupportsBulkLoad<TreeType>::value>());
+    
     return tree;
 }
 
+/**
+ * Parses file on the given number of threads and returns a tree of type
+ * TreeType containing data in file
+ */
+template <typename TreeType>
+TreeType parseTreeParallel(const MappedFile &file, int threads) {
+    
+    int count = 0;
+    return parseTreeParallel<TreeType>(file, threads, count);
+}
+
+/**
+ * Returns true if the file at snapshot exists and was modified no earlier
+ * than the file at filename
+ */
+inline bool isSnapshotCurrent(const string &snapshot, const string &filename) {
+    
+    struct stat snapshot_stat, file_stat;
+    if (stat(snapshot.c_str(), &snapshot_stat) != 0 || stat(filename.c_str(), &file_stat) != 0) {
+        return false;
+    }
+    if (snapshot_stat.st_mtim.tv_sec != file_stat.st_mtim.tv_sec) {
+        return snapshot_stat.st_mtim.tv_sec > file_stat.st_mtim.tv_sec;
+    }
+    return snapshot_stat.st_mtim.tv_nsec >= file_stat.st_mtim.tv_nsec;
+}
+
+/**
+ * Returns a tree of type TreeType containing data in file, the mapped file
+ * named filename. If snapshot names a valid snapshot no older than
+ * filename, the tree is loaded from it without parsing. Otherwise file is
+ * parsed on the given number of threads and, if snapshot is not empty, the
+ * tree is saved there for the next run.
+ */
+template <typename TreeType>
+TreeType openTree(const MappedFile &file, const string &filename, int threads, const string &snapshot) {
+    
+    TreeType tree;
+    if (!snapshot.empty() && isSnapshotCurrent(snapshot, filename) && tree.load(snapshot)) {
+        return tree;
+    }
+    
+    tree = parseTreeParallel<TreeType>(file, threads);
+    if (!snapshot.empty() && !tree.save(snapshot)) {
+        cerr << "WARNING: Could not write snapshot " << snapshot << endl;
+    }
+    return tree;
+}
+
+/**
+ * Parses file and returns a tree of type TreeType containing data in file,
+ * always inserting one sequence at a time, even if TreeType supports bulk
+ * loading
+ * Counts number of times insert() function is recursively called on the tree
+ */
+template <typename TreeType>
+TreeType parseTreeByInsert(istream &readf, int &count) {
+    
+    TreeType tree;
+    vector<SequenceMap> smaps = readSequenceMaps(readf);
+    insertSequenceMaps(tree, smaps, count);
+    
+    return tree;
+}
+
+/**
+ * True if TreeType has a prefix(p) member, as the binary trees do
+ */
+template <typename TreeType>
+class SupportsPrefix {
+    template <typename T>
+    static auto test(int) -> decltype(declval<const T&>().prefix(declval<const SequenceMap&>()), true_type());
+    
+    template <typename T>
+    static false_type test(...);
+    
+public:
+    static const bool value = decltype(test<TreeType>(0))::value;
+};
+
+/**
+ * Prints every sequence in tree that starts with prefix, with its enzymes,
+ * and then the number found
+ */
+template <typename TreeType>
+void printPrefixMatches(TreeType &tree, const string &prefix, true_type) {
+    
+    size_t found = 0;
+    for (const SequenceMap &smap : tree.prefix(SequenceMap(prefix, ""))) {
+        cout << "SEQUENCE: " << smap.getSequence() << endl << smap << endl;
+        found++;
+    }
+    cout << found << " sequence(s) start with " << prefix << endl;
+}
+
+template <typename TreeType>
+void printPrefixMatches(TreeType &, const string &, false_type) {
+    cout << "Prefix search is not supported by this tree type." << endl;
+}
+
 /**
  * Prompts user for recognition sequence, searches tree for given sequence
  * If sequence is found in tree, prints out a list of enzyme acronyms for that
- * sequence
+ * sequence. A sequence ending in * lists every sequence starting with the
+ * rest instead
  */
 template <typename TreeType>
 void printSequenceMap(TreeType &tree){
@@ -137,6 +536,10 @@ void printSequenceMap(TreeType &tree){
         if (query == "q") {
             cont = false;
         }
+        else if (!query.empty() && query.back() == '*') {
+            query.pop_back();
+            printPrefixMatches(tree, query, integral_constant<bool, SupportsPrefix<TreeType>::value>());
+        }
         else {
             SequenceMap seqmap_query(query, "");
             tree.printNode(seqmap_query);
@@ -0,0 +1,320 @@
+#include "TreeSnapshot.h"
+
+/*****************************************************************************
+ Title:             TreeSnapshot.cpp
+ Created on:        October 18, 2026
+ Description:       Implementation of SnapshotWriter and SnapshotReader
+
+ *****************************************************************************/
+
+#include <cstring>
+#include <fstream>
+
+// Identifies a snapshot file, and the layout version it was written with
+static const char MAGIC[8] = {'S', 'E', 'Q', 'S', 'N', 'A', 'P', '\n'};
+static const uint32_t VERSION = 1;
+
+// Header flags
+static const uint32_t HAS_SHAPE = 1;
+static const uint32_t HAS_DELETED = 2;
+
+// Text offset of a key whose sequence is stored packed
+static const uint32_t PACKED = UINT32_MAX;
+
+// Snapshot id not yet given to an AcronymTable id
+static const uint32_t NO_ID = UINT32_MAX;
+
+/**
+* Fixed header at the start of a snapshot
+*/
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t keys;              // Keys, in sorted order
+    uint64_t ids;               // Acronym ids of all keys together
+    uint64_t acronyms;          // Distinct acronyms
+    uint64_t acronymBytes;      // Text of all acronyms
+    uint64_t textBytes;         // Text of sequences that are not packed
+    uint64_t checksum;          // Of every byte after the header
+};
+
+/**
+* A key record is four words: the packed sequence words, the sequence
+* length and the offset of its text (or PACKED), and the first acronym id
+* and number of ids.
+*/
+static const size_t RECORD_WORDS = 4;
+
+/**
+* Rounds n up to a multiple of 8
+*/
+static size_t aligned(size_t n) {
+    return (n + 7) & ~static_cast<size_t>(7);
+}
+
+/**
+* Mixes the data 8 bytes at a time. The tail is zero padded.
+*/
+uint64_t snapshotChecksum(const char *data, size_t size) {
+    const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+    const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+    uint64_t h = size * PRIME1;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        h ^= word * PRIME2;
+        h = ((h << 31) | (h >> 33)) * PRIME1;
+    }
+    if (i < size) {
+        uint64_t word = 0;
+        memcpy(&word, data + i, size - i);
+        h ^= word * PRIME2;
+        h = ((h << 31) | (h >> 33)) * PRIME1;
+    }
+    h ^= h >> 29;
+    h *= PRIME2;
+    h ^= h >> 32;
+    return h;
+}
+
+SnapshotWriter::SnapshotWriter(bool withShape):shape(withShape), anyDeleted(false) { }
+
+/**
+* Adds the key x. Its acronyms are renumbered in order of first use, so the
+* snapshot holds only the acronyms its keys need.
+*/
+void SnapshotWriter::add(const SequenceMap &x, uint32_t depth, bool isDeleted) {
+    const PackedSequence &key = x.getKey();
+    uint64_t offset = PACKED;
+    if (!key.isPacked()) {
+        offset = text.size();
+        text += key.toString();
+    }
+    records.push_back(key.isPacked() ? key.highWord() : 0);
+    records.push_back(key.isPacked() ? key.lowWord() : 0);
+    records.push_back(static_cast<uint64_t>(key.length()) << 32 | offset);
+    records.push_back(static_cast<uint64_t>(ids.size()) << 32 | x.getAcronymIds().size());
+
+    for (uint32_t id : x.getAcronymIds()) {
+        if (id >= localIds.size()) {
+            localIds.resize(id + 1, NO_ID);
+        }
+        if (localIds[id] == NO_ID) {
+            localIds[id] = static_cast<uint32_t>(acronyms.size());
+            acronyms.push_back(id);
+        }
+        ids.push_back(localIds[id]);
+    }
+    depths.push_back(depth);
+    deleted.push_back(isDeleted ? 1 : 0);
+    anyDeleted = anyDeleted || isDeleted;
+}
+
+bool SnapshotWriter::write(const string &path) const {
+
+    // Offsets and id ranges are stored in 32 bits
+    if (text.size() >= PACKED || ids.size() >= UINT32_MAX) {
+        return false;
+    }
+
+    // Acronym table: offsets of each acronym's text, then the text
+    vector<uint64_t> offsets(1, 0);
+    string names;
+    for (uint32_t id : acronyms) {
+        names += AcronymTable::name(id);
+        offsets.push_back(names.size());
+    }
+
+    string payload;
+    auto append = [&payload](const void *data, size_t bytes) {
+        payload.append(static_cast<const char *>(data), bytes);
+        payload.resize(aligned(payload.size()), '\0');
+    };
+    append(records.data(), records.size() * sizeof(uint64_t));
+    append(ids.data(), ids.size() * sizeof(uint32_t));
+    if (shape) {
+        append(depths.data(), depths.size() * sizeof(uint32_t));
+    }
+    if (anyDeleted) {
+        append(deleted.data(), deleted.size());
+    }
+    append(offsets.data(), offsets.size() * sizeof(uint64_t));
+    append(names.data(), names.size());
+    append(text.data(), text.size());
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.flags = (shape ? HAS_SHAPE : 0) | (anyDeleted ? HAS_DELETED : 0);
+    header.keys = depths.size();
+    header.ids = ids.size();
+    header.acronyms = acronyms.size();
+    header.acronymBytes = names.size();
+    header.textBytes = text.size();
+    header.checksum = snapshotChecksum(payload.data(), payload.size());
+
+    ofstream out(path, ios::binary | ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(payload.data(), payload.size());
+    out.close();
+    return !out.fail();
+}
+
+SnapshotReader::SnapshotReader(const string &path):file(path), failed(true), keys(0),
+    records(nullptr), ids(nullptr), savedDepths(nullptr), deleted(nullptr), text(nullptr) {
+    failed = file.fail() || !open();
+    if (failed) {
+        keys = 0;
+    }
+}
+
+bool SnapshotReader::open() {
+
+    string_view bytes = file.view();
+    SnapshotHeader header;
+    if (bytes.size() < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, bytes.data(), sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+        return false;
+    }
+
+    // Every section must fit, so a truncated file is caught before the
+    // checksum is even computed
+    const uint64_t limit = bytes.size();
+    if (header.keys > limit || header.ids > limit || header.acronyms > limit ||
+        header.acronymBytes > limit || header.textBytes > limit) {
+        return false;
+    }
+    size_t at = sizeof(header);
+    size_t recordsAt = at;
+    at += aligned(header.keys * RECORD_WORDS * sizeof(uint64_t));
+    size_t idsAt = at;
+    at += aligned(header.ids * sizeof(uint32_t));
+    size_t depthsAt = at;
+    if (header.flags & HAS_SHAPE) {
+        at += aligned(header.keys * sizeof(uint32_t));
+    }
+    size_t deletedAt = at;
+    if (header.flags & HAS_DELETED) {
+        at += aligned(header.keys);
+    }
+    size_t offsetsAt = at;
+    at += aligned((header.acronyms + 1) * sizeof(uint64_t));
+    size_t namesAt = at;
+    at += aligned(header.acronymBytes);
+    size_t textAt = at;
+    at += aligned(header.textBytes);
+    if (at != bytes.size()) {
+        return false;
+    }
+
+    const char *base = bytes.data();
+    if (snapshotChecksum(base + sizeof(header), bytes.size() - sizeof(header)) != header.checksum) {
+        return false;
+    }
+
+    // The mapping is page aligned and every section starts on 8 bytes
+    keys = header.keys;
+    records = reinterpret_cast<const uint64_t *>(base + recordsAt);
+    ids = reinterpret_cast<const uint32_t *>(base + idsAt);
+    savedDepths = (header.flags & HAS_SHAPE) ? reinterpret_cast<const uint32_t *>(base + depthsAt) : nullptr;
+    deleted = (header.flags & HAS_DELETED) ? reinterpret_cast<const uint8_t *>(base + deletedAt) : nullptr;
+    text = base + textAt;
+
+    // Check every reference into the other sections
+    for (size_t i = 0; i < keys; i++) {
+        const uint64_t *record = records + RECORD_WORDS * i;
+        uint64_t length = record[2] >> 32;
+        uint64_t offset = record[2] & UINT32_MAX;
+        uint64_t first = record[3] >> 32;
+        uint64_t count = record[3] & UINT32_MAX;
+        if (offset == PACKED ? length > PackedSequence::MAX_PACKED : offset + length > header.textBytes) {
+            return false;
+        }
+        if (first + count > header.ids) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < header.ids; i++) {
+        if (ids[i] >= header.acronyms) {
+            return false;
+        }
+    }
+
+    // Intern the acronyms once, so keys can be built from ids
+    const uint64_t *offsets = reinterpret_cast<const uint64_t *>(base + offsetsAt);
+    for (size_t a = 0; a < header.acronyms; a++) {
+        if (offsets[a] > offsets[a + 1] || offsets[a + 1] > header.acronymBytes) {
+            return false;
+        }
+    }
+    acronyms.reserve(header.acronyms);
+    for (size_t a = 0; a < header.acronyms; a++) {
+        acronyms.push_back(AcronymTable::intern(string_view(base + namesAt + offsets[a], offsets[a + 1] - offsets[a])));
+    }
+    return true;
+}
+
+SequenceMap SnapshotReader::element(size_t i) const {
+    const uint64_t *record = records + RECORD_WORDS * i;
+    uint32_t length = static_cast<uint32_t>(record[2] >> 32);
+    uint32_t offset = static_cast<uint32_t>(record[2]);
+    PackedSequence key = (offset == PACKED)
+        ? PackedSequence::fromWords(record[0], record[1], length)
+        : PackedSequence(string_view(text + offset, length));
+
+    AcronymSet set;
+    uint32_t first = static_cast<uint32_t>(record[3] >> 32);
+    uint32_t count = static_cast<uint32_t>(record[3]);
+    for (uint32_t k = first; k < first + count; k++) {
+        set.insert(acronyms[ids[k]]);
+    }
+    return SequenceMap(move(key), move(set));
+}
+
+bool SnapshotReader::isDeleted(size_t i) const {
+    return deleted != nullptr && deleted[i] != 0;
+}
+
+vector<uint32_t> SnapshotReader::depths() const {
+    if (savedDepths != nullptr) {
+        return vector<uint32_t>(savedDepths, savedDepths + keys);
+    }
+    return balancedDepths();
+}
+
+/**
+* Returns the depths in the tree that splits each range of keys at its
+* middle, as bulk loading does
+*/
+vector<uint32_t> SnapshotReader::balancedDepths() const {
+    vector<uint32_t> balanced(keys);
+    vector<pair<size_t, size_t>> ranges;      // [lo, hi) at the depth of its slot in balanced
+    if (keys > 0) {
+        ranges.push_back(make_pair(0, keys));
+    }
+    vector<uint32_t> rangeDepths(ranges.size(), 0);
+    while (!ranges.empty()) {
+        size_t lo = ranges.back().first;
+        size_t hi = ranges.back().second;
+        uint32_t depth = rangeDepths.back();
+        ranges.pop_back();
+        rangeDepths.pop_back();
+        size_t mid = lo + (hi - 1 - lo) / 2;
+        balanced[mid] = depth;
+        if (lo < mid) {
+            ranges.push_back(make_pair(lo, mid));
+            rangeDepths.push_back(depth + 1);
+        }
+        if (mid + 1 < hi) {
+            ranges.push_back(make_pair(mid + 1, hi));
+            rangeDepths.push_back(depth + 1);
+        }
+    }
+    return balanced;
+}
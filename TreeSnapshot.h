@@ -0,0 +1,181 @@
+/*****************************************************************************
+ Title:             TreeSnapshot.h
+ Created on:        October 18, 2026
+ Description:       Binary snapshot of a tree of SequenceMaps, so a program
+                    can start from a file that is read back without being
+                    parsed.
+
+                    A snapshot holds, after a fixed header:
+                        - one 32-byte record per key, in sorted order, with
+                          the packed words of its sequence and the range of
+                          its acronym ids
+                        - the acronym ids of every key, numbered within the
+                          snapshot
+                        - optionally, the depth of each key in the tree it
+                          was saved from, which fixes the tree's shape
+                        - optionally, a deleted flag per key
+                        - the acronym table and the text of any sequence
+                          that could not be packed
+                    Sections start on 8-byte boundaries. The header holds a
+                    version, the section sizes and a checksum of everything
+                    after it. Numbers are stored in the byte order of the
+                    machine that wrote the file.
+
+                    SnapshotReader maps the file, checks it and hands back
+                    the keys; the trees allocate their nodes in sorted order
+                    and link them with linkByDepth(), so loading makes no
+                    key comparisons.
+
+ *****************************************************************************/
+
+#ifndef TREESNAPSHOT_H
+#define TREESNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "MappedFile.h"
+#include "SequenceMap.h"
+using namespace std;
+
+class SnapshotWriter {
+public:
+
+    // Saves the tree's shape with its keys if withShape is true
+    explicit SnapshotWriter(bool withShape = true);
+
+    // Adds the next key in sorted order, at depth in its tree
+    void add (const SequenceMap &x, uint32_t depth, bool deleted = false);
+
+    // Writes the snapshot to path. Returns false if it could not be written.
+    bool write (const string &path) const;
+
+private:
+
+    bool shape;
+    bool anyDeleted;
+    vector<uint64_t> records;           // Four words per key
+    vector<uint32_t> ids;               // Snapshot acronym ids of every key
+    vector<uint32_t> depths;
+    vector<uint8_t> deleted;
+    vector<uint32_t> localIds;          // Snapshot id of each AcronymTable id
+    vector<uint32_t> acronyms;          // AcronymTable id of each snapshot id
+    string text;                        // Sequences that are not packed
+};
+
+class SnapshotReader {
+public:
+
+    // Maps path and checks it. Check fail() before reading keys.
+    explicit SnapshotReader(const string &path);
+
+    // True if the file could not be read or is not a valid snapshot
+    bool fail () const {
+        return failed;
+    }
+
+    // Returns the number of keys
+    size_t size () const {
+        return keys;
+    }
+
+    // Returns key i, in sorted order, with its acronyms interned
+    SequenceMap element (size_t i) const;
+
+    // True if key i was deleted in a tree with lazy deletion
+    bool isDeleted (size_t i) const;
+
+    // Returns the depth of each key in the saved tree, or in a balanced
+    // tree if the snapshot holds no shape
+    vector<uint32_t> depths () const;
+
+    // Returns the depth of each key in a balanced tree
+    vector<uint32_t> balancedDepths () const;
+
+private:
+
+    MappedFile file;
+    bool failed;
+    size_t keys;
+    const uint64_t *records;
+    const uint32_t *ids;
+    const uint32_t *savedDepths;        // nullptr if there is no shape
+    const uint8_t *deleted;             // nullptr if nothing was deleted
+    const char *text;
+    vector<uint32_t> acronyms;          // AcronymTable id of each snapshot id
+
+    // Checks the header and section bounds and sets up the views. Returns
+    // false if the snapshot is not valid.
+    bool open ();
+};
+
+// Returns a checksum of the size bytes at data
+uint64_t snapshotChecksum (const char *data, size_t size);
+
+/**
+ * Walks the subtree rooted at root in sorted order with an explicit stack,
+ * so a tall tree cannot overflow the call stack. Calls visit( node, depth )
+ * on every node.
+ */
+template <typename Node, typename Visit>
+void inOrderWithDepth(Node *root, Visit visit) {
+    vector<pair<Node *, uint32_t>> stack;
+    Node *t = root;
+    uint32_t depth = 0;
+    while (t != nullptr || !stack.empty()) {
+        while (t != nullptr) {
+            stack.push_back(make_pair(t, depth));
+            t = t->left;
+            depth++;
+        }
+        t = stack.back().first;
+        depth = stack.back().second;
+        stack.pop_back();
+        visit(t, depth);
+        t = t->right;
+        depth++;
+    }
+}
+
+/**
+ * Links nodes, given in sorted order with the depth of each, back into the
+ * tree they were saved from, and returns its root. A node's parent is the
+ * nearer of its neighbours above it, so one pass with a stack of the right
+ * spine built so far links every node. Calls finish( node ) on each node
+ * once its subtree is complete, children first. Existing links are
+ * overwritten, so the same nodes can be linked again into another shape.
+ */
+template <typename Node, typename Finish>
+Node *linkByDepth(const vector<Node *> &nodes, const vector<uint32_t> &depths, Finish finish) {
+    vector<Node *> spine;
+    vector<uint32_t> spineDepths;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        Node *last = nullptr;
+        while (!spine.empty() && spineDepths.back() > depths[i]) {
+            last = spine.back();
+            spine.pop_back();
+            spineDepths.pop_back();
+            finish(last);
+        }
+        nodes[i]->left = last;
+        nodes[i]->right = nullptr;
+        if (!spine.empty()) {
+            spine.back()->right = nodes[i];
+        }
+        spine.push_back(nodes[i]);
+        spineDepths.push_back(depths[i]);
+    }
+    while (spine.size() > 1) {
+        finish(spine.back());
+        spine.pop_back();
+    }
+    if (spine.empty()) {
+        return nullptr;
+    }
+    finish(spine.back());
+    return spine.back();
+}
+
+#endif
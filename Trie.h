@@ -0,0 +1,543 @@
+#ifndef TRIE_H
+#define TRIE_H
+
+/*****************************************************************************
+ Title:             Trie.h
+ Created on:        October 18, 2026
+ Description:       Template class for a compressed radix (Patricia) trie
+                    keyed by the text of each element's sequence.
+
+                    Each edge is labelled with a run of symbols, so a chain
+                    of nodes with one child each is one node, and the path
+                    from the root to a node spells its key. A search reads
+                    each symbol of the key once, picking the child whose
+                    label starts with the next symbol and matching the rest
+                    of the label, so it costs the key's length rather than
+                    log n whole-key comparisons. Sites that share a prefix,
+                    like the many GCANNNN... and CACNN... sites, share the
+                    nodes that spell it.
+
+                    A node's element, if any, sorts before its children, and
+                    children are kept in order of their first symbol, so a
+                    preorder walk gives the elements in sorted order.
+
+                    Comparable must have getKey( ), as SequenceMap does,
+                    returning a key with length( ) and copyText( out ).
+
+ ****************************************************************************/
+
+#include "NodePool.h"
+#include "TreeSnapshot.h"
+#include <algorithm>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+using namespace std;
+
+// Trie class
+//
+// CONSTRUCTION: zero parameter. Nodes come from Allocator, a NodePool by
+//               default (see NodePool.h).
+//
+// ******************PUBLIC OPERATIONS*********************
+// void insert( x, count )     --> Insert x; duplicates are merged. Adds to
+//                                 count the nodes visited.
+// bool remove( x, count )     --> Removes x. Adds to count the nodes
+//                                 visited.
+// bool contains( x, count )   --> Return true if x is present; else false.
+//                                 Adds to count the nodes visited.
+// vector<bool> containsBatch( xs, count )
+//                             --> Result i is true if xs[i] is present.
+//                                 Adds to count the nodes visited.
+// boolean isEmpty( )          --> Return true if empty; else false
+// void makeEmpty( )           --> Remove all items
+// void printTree( )           --> Print trie in sorted order
+// void printNode(x)           --> Prints element in node containing x
+// void inOrder( visit )       --> Calls visit( element ) on every element
+//                                 in sorted order
+// int nodes( )                --> Returns the number of elements
+// int trieNodes( )            --> Returns the number of nodes, including
+//                                 those that only branch
+// int internalPathLength( )   --> Returns the sum of the depth of the node
+//                                 of every element, the root being at 0
+// long keyComparisons( )      --> Returns the number of key symbols compared
+//                                 by insert, remove and contains
+// bool save( path, shape )    --> Writes the elements to a snapshot file
+//                                 (see TreeSnapshot.h). The shape of a trie
+//                                 follows from its keys, so shape is
+//                                 ignored. Returns false on failure.
+// bool load( path )           --> Replaces the contents with a snapshot.
+//                                 Returns false, leaving the trie as it
+//                                 was, if the file is not a valid snapshot.
+
+template <typename Comparable, template <typename> class Allocator = NodePool>
+class Trie
+{
+public:
+
+
+/******************************************************************************
+     PUBLIC CONSTRUCTORS, DESTRUCTORS, MOVERS
+******************************************************************************/
+
+    Trie( ) : root{ nullptr }, size{ 0 }, comparisons{ 0 } {
+        root = pool.create( string_view( ) );
+    }
+
+    Trie( const Trie & rhs ) = delete;
+    Trie & operator=( const Trie & rhs ) = delete;
+
+    Trie( Trie && rhs ) : Trie( ) {
+        *this = std::move( rhs );
+    }
+
+    ~Trie( ) {
+        destroy( root );
+    }
+
+    /**
+     * Move.
+     */
+    Trie & operator=( Trie && rhs ) {
+        std::swap( root, rhs.root );
+        std::swap( pool, rhs.pool );
+        std::swap( size, rhs.size );
+        std::swap( comparisons, rhs.comparisons );
+        return *this;
+    }
+
+
+/******************************************************************************
+     PUBLIC FIND FUNCTIONS
+******************************************************************************/
+
+    /**
+     * Returns true if x is found in the trie. Else returns false
+     * Counts the nodes visited
+     */
+    bool contains( const Comparable & x, int & count ) const {
+        KeyText key( x );
+        return find( key.view( ), count ) != nullptr;
+    }
+
+    /**
+     * Returns, for each query, true if it is found in the trie
+     * Counts the nodes visited
+     */
+    vector<bool> containsBatch( const vector<Comparable> & queries, int & count ) const {
+        vector<bool> results( queries.size( ) );
+        for( size_t i = 0; i < queries.size( ); i++ )
+            results[ i ] = contains( queries[ i ], count );
+        return results;
+    }
+
+
+/*****************************************************************************
+     PUBLIC PRINT FUNCTIONS
+*****************************************************************************/
+
+    /**
+     * Prints contents of the node containing element x
+     */
+    void printNode( const Comparable & x ) const {
+        KeyText key( x );
+        int count = 0;
+        TrieNode *found = find( key.view( ), count );
+        if( found == nullptr )
+            cout << "Element not found in tree." << endl;
+        else
+            cout << *found->element << endl;
+    }
+
+    /**
+     * Print the trie contents in sorted order.
+     */
+    void printTree( ) const {
+        if( isEmpty( ) )
+            cout << "Empty tree" << endl;
+        else
+            inOrder( [ ]( const Comparable & element ) { cout << element << endl; } );
+    }
+
+    /**
+     * Calls visit( element ) on every element in sorted order
+     */
+    template <typename Visitor>
+    void inOrder( Visitor visit ) const {
+        inOrder( root, visit );
+    }
+
+
+/*****************************************************************************
+     PUBLIC INSERT/REMOVE FUNCTIONS
+*****************************************************************************/
+
+    /**
+     * Make the trie logically empty.
+     */
+    void makeEmpty( ) {
+        destroy( root );
+        pool.release( );
+        root = pool.create( string_view( ) );
+        size = 0;
+    }
+
+    /**
+     * Insert x into the trie; duplicates are merged
+     * Counts the nodes visited
+     */
+    void insert( const Comparable & x, int & count ) {
+        add( x, count );
+    }
+
+    void insert( Comparable && x, int & count ) {
+        add( std::move( x ), count );
+    }
+
+    /**
+     * Remove x from the trie. Nothing is done if x is not found. A node left
+     * with no element and one child is joined to the child, so the trie
+     * stays compressed.
+     * Counts the nodes visited
+     */
+    bool remove( const Comparable & x, int & count ) {
+        KeyText text( x );
+        string_view key = text.view( );
+
+        TrieNode *parent = nullptr;
+        TrieNode *t = root;
+        size_t i = 0;
+        for( ; ; ) {
+            count++;
+            if( i == key.size( ) )
+                break;
+            TrieNode *child = matchChild( t, key, i );
+            if( child == nullptr )
+                return false;
+            parent = t;
+            t = child;
+        }
+        if( !t->element )
+            return false;
+
+        t->element.reset( );
+        size--;
+        if( t != root && t->children.empty( ) ) {
+            removeChild( parent, t );
+            pool.destroy( t );
+            t = parent;
+        }
+        if( t != root && !t->element && t->children.size( ) == 1 )
+            joinChild( t );
+        return true;
+    }
+
+
+/******************************************************************************
+     PUBLIC SNAPSHOT FUNCTIONS
+******************************************************************************/
+
+    /**
+     * Writes the trie to a snapshot file at path, its elements in sorted
+     * order. Returns false if the file could not be written.
+     */
+    bool save( const string & path, bool /*shape*/ = true ) const {
+        SnapshotWriter writer( false );
+        inOrder( [ &writer ]( const Comparable & element ) { writer.add( element, 0 ); } );
+        return writer.write( path );
+    }
+
+    /**
+     * Replaces the contents of the trie with the snapshot at path.
+     * Returns false, leaving the trie unchanged, if path is not a valid
+     * snapshot.
+     */
+    bool load( const string & path ) {
+        SnapshotReader reader( path );
+        if( reader.fail( ) )
+            return false;
+
+        makeEmpty( );
+        long saved = comparisons;
+        int count = 0;
+        for( size_t i = 0; i < reader.size( ); i++ )
+            add( reader.element( i ), count );
+        comparisons = saved;
+        return true;
+    }
+
+
+/******************************************************************************
+    PUBLIC FUNCTIONS TO GET TREE CHARACTERISTICS
+ ******************************************************************************/
+
+    bool isEmpty( ) const {
+        return size == 0;
+    }
+
+    /**
+     * Returns the number of elements in the trie
+     */
+    int nodes( ) const {
+        return size;
+    }
+
+    /**
+     * Returns the number of nodes in the trie, including the root and nodes
+     * that only branch
+     */
+    int trieNodes( ) const {
+        return countNodes( root );
+    }
+
+    /**
+     * Returns the sum of the depth of every element's node, i.e. of the
+     * nodes visited below the root to find each element
+     */
+    int internalPathLength( ) const {
+        return totalDepth( root, 0 );
+    }
+
+    /**
+     * Returns the number of key symbols compared with edge labels by insert,
+     * remove and contains since the trie was created
+     */
+    long keyComparisons( ) const {
+        return comparisons;
+    }
+
+
+private:
+
+/*****************************************************************************
+     Member Data
+*****************************************************************************/
+
+    struct TrieNode
+    {
+        string label;                   // Symbols on the edge from the parent
+        string branches;                // First symbol of each child's label,
+                                        // in sorted order
+        vector<TrieNode *> children;    // In the order of branches
+        optional<Comparable> element;   // Element whose key ends here
+
+        explicit TrieNode( string_view l ) : label{ l } { }
+    };
+
+    /**
+     * The text of an element's key, on the stack unless it is long
+     */
+    class KeyText
+    {
+    public:
+        explicit KeyText( const Comparable & x ) {
+            const auto & key = x.getKey( );
+            length = key.length( );
+            if( length > sizeof( local ) )
+                spilled.resize( length );
+            data = ( length > sizeof( local ) ) ? &spilled[ 0 ] : local;
+            key.copyText( data );
+        }
+
+        KeyText( const KeyText & rhs ) = delete;
+        KeyText & operator=( const KeyText & rhs ) = delete;
+
+        string_view view( ) const {
+            return string_view( data, length );
+        }
+
+    private:
+        char local[ 64 ];
+        string spilled;
+        char *data;
+        size_t length;
+    };
+
+    TrieNode *root;             // Empty label; holds the empty key, if any
+    Allocator<TrieNode> pool;
+    int size;                   // Elements held
+    mutable long comparisons;   // Key symbols compared so far
+
+
+/*****************************************************************************
+     Find Functions
+*****************************************************************************/
+
+    /**
+     * Returns the child of t whose label matches key from position i,
+     * advancing i past the label, or nullptr if there is none
+     */
+    TrieNode * matchChild( TrieNode *t, string_view key, size_t & i ) const {
+        size_t b = t->branches.find( key[ i ] );
+        if( b == string::npos )
+            return nullptr;
+        TrieNode *child = t->children[ b ];
+        size_t n = child->label.size( );
+        size_t common = commonPrefix( child->label, key.substr( i ) );
+        comparisons += min( common + 1, n );
+        if( common < n )
+            return nullptr;
+        i += n;
+        return child;
+    }
+
+    /**
+     * Returns the node holding the element with the given key, or nullptr
+     * Counts the nodes visited
+     */
+    TrieNode * find( string_view key, int & count ) const {
+        TrieNode *t = root;
+        size_t i = 0;
+        for( ; ; ) {
+            count++;
+            if( i == key.size( ) )
+                return t->element ? t : nullptr;
+            t = matchChild( t, key, i );
+            if( t == nullptr )
+                return nullptr;
+        }
+    }
+
+    /**
+     * Returns the number of leading symbols a and b share
+     */
+    static size_t commonPrefix( string_view a, string_view b ) {
+        size_t n = min( a.size( ), b.size( ) );
+        size_t i = 0;
+        while( i < n && a[ i ] == b[ i ] )
+            i++;
+        return i;
+    }
+
+
+/*****************************************************************************
+     Insert/Remove Functions
+*****************************************************************************/
+
+    /**
+     * Inserts x, splitting the edge where its key leaves the trie
+     * Counts the nodes visited
+     */
+    template <typename Element>
+    void add( Element && x, int & count ) {
+        KeyText text( x );
+        string_view key = text.view( );
+
+        TrieNode *t = root;
+        size_t i = 0;
+        for( ; ; ) {
+            count++;
+            if( i == key.size( ) ) {
+                place( t, std::forward<Element>( x ) );
+                return;
+            }
+
+            size_t b = t->branches.find( key[ i ] );
+            if( b == string::npos ) {
+                TrieNode *leaf = pool.create( key.substr( i ) );
+                place( leaf, std::forward<Element>( x ) );
+                addChild( t, leaf );
+                return;
+            }
+
+            TrieNode *child = t->children[ b ];
+            size_t common = commonPrefix( child->label, key.substr( i ) );
+            comparisons += min( common + 1, child->label.size( ) );
+            if( common < child->label.size( ) ) {
+                // Split the edge where the key leaves it
+                TrieNode *middle = pool.create( string_view( child->label ).substr( 0, common ) );
+                child->label.erase( 0, common );
+                middle->branches.push_back( child->label[ 0 ] );
+                middle->children.push_back( child );
+                t->children[ b ] = middle;
+                child = middle;
+            }
+            t = child;
+            i += common;
+        }
+    }
+
+    /**
+     * Puts x in t, merging it with t's element if it has one
+     */
+    template <typename Element>
+    void place( TrieNode *t, Element && x ) {
+        if( t->element )
+            t->element->merge( std::forward<Element>( x ) );
+        else {
+            t->element.emplace( std::forward<Element>( x ) );
+            size++;
+        }
+    }
+
+    /**
+     * Adds child to t, keeping the children in order of first symbol
+     */
+    void addChild( TrieNode *t, TrieNode *child ) {
+        unsigned char first = child->label[ 0 ];
+        size_t b = 0;
+        while( b < t->branches.size( ) && static_cast<unsigned char>( t->branches[ b ] ) < first )
+            b++;
+        t->branches.insert( b, 1, child->label[ 0 ] );
+        t->children.insert( t->children.begin( ) + b, child );
+    }
+
+    void removeChild( TrieNode *t, TrieNode *child ) {
+        size_t b = t->branches.find( child->label[ 0 ] );
+        t->branches.erase( b, 1 );
+        t->children.erase( t->children.begin( ) + b );
+    }
+
+    /**
+     * Joins t's only child into t
+     */
+    void joinChild( TrieNode *t ) {
+        TrieNode *child = t->children[ 0 ];
+        t->label += child->label;
+        t->branches = std::move( child->branches );
+        t->children = std::move( child->children );
+        t->element = std::move( child->element );
+        pool.destroy( child );
+    }
+
+    /**
+     * Destroys the subtrie rooted at t
+     */
+    void destroy( TrieNode *t ) {
+        for( TrieNode *child : t->children )
+            destroy( child );
+        pool.destroy( t );
+    }
+
+
+/*****************************************************************************
+     Traversal Functions
+*****************************************************************************/
+
+    template <typename Visitor>
+    void inOrder( TrieNode *t, Visitor & visit ) const {
+        if( t->element )
+            visit( *t->element );
+        for( TrieNode *child : t->children )
+            inOrder( child, visit );
+    }
+
+    int countNodes( TrieNode *t ) const {
+        int n = 1;
+        for( TrieNode *child : t->children )
+            n += countNodes( child );
+        return n;
+    }
+
+    int totalDepth( TrieNode *t, int depth ) const {
+        int total = t->element ? depth : 0;
+        for( TrieNode *child : t->children )
+            total += totalDepth( child, depth + 1 );
+        return total;
+    }
+};
+
+#endif
@@ -0,0 +1,187 @@
+/*****************************************************************************
+ Title:             benchConcurrent.cpp
+ Created on:        October 18, 2026
+ Description:       Measures read/write throughput of ConcurrentAvlTree and
+                    SkipList from 1 to a given number of threads, against
+                    an AvlTree behind one mutex.
+                    1. Parses a given file of enzymes and recognition
+                    sequences into each, and makes queries of which
+                    half are in the database.
+                    2. For 1, 2, 4, ... threads up to the given number, runs
+                    every thread for a given time. Each operation is an
+                    insert of a query under a new enzyme at a given rate,
+                    and otherwise a contains().
+                    3. Prints the operations per second of each and
+                    the speedup over one thread.
+
+ ****************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include "AvlTree.h"
+#include "ConcurrentAvlTree.h"
+#include "SkipList.h"
+#include "TreeParser.h"
+
+using namespace std;
+
+/**
+ * An AvlTree that every operation locks, for comparison
+ */
+class LockedAvlTree {
+public:
+
+    bool contains(const SequenceMap &x, int &count) {
+        lock_guard<mutex> guard(lock);
+        return tree.contains(x, count);
+    }
+
+    void insert(const SequenceMap &x, int &count) {
+        lock_guard<mutex> guard(lock);
+        tree.insert(x, count);
+    }
+
+private:
+
+    mutex lock;
+    AvlTree<SequenceMap> tree;
+};
+
+/**
+ * Runs threads threads on tree for seconds seconds. Each operation is an
+ * insert with probability write_rate, and a contains() otherwise. Returns
+ * the operations per second over all threads.
+ */
+template <typename TreeType>
+double runThreads(TreeType &tree, const vector<SequenceMap> &queries, const vector<SequenceMap> &writes,
+                  int threads, double write_rate, double seconds) {
+
+    atomic<bool> stop(false);
+    atomic<long> operations(0);
+    vector<thread> workers;
+
+    for (int t = 0; t < threads; t++) {
+        workers.push_back(thread([&, t]() {
+            mt19937_64 random(t + 1);
+            bernoulli_distribution write(write_rate);
+            long done = 0;
+            long found = 0;
+            int count = 0;
+            while (!stop.load(memory_order_relaxed)) {
+                // Check the clock only every so often
+                for (int i = 0; i < 256; i++) {
+                    size_t q = random() % queries.size();
+                    if (write(random)) {
+                        tree.insert(writes[q], count);
+                    }
+                    else {
+                        found += tree.contains(queries[q], count);
+                    }
+                    count = 0;
+                }
+                done += 256;
+            }
+            operations += done;
+            // Keeps the lookups from being optimised away
+            if (found < 0) {
+                cerr << found;
+            }
+        }));
+    }
+
+    auto start = chrono::steady_clock::now();
+    this_thread::sleep_for(chrono::duration<double>(seconds));
+    stop = true;
+    for (thread &worker : workers) {
+        worker.join();
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    return operations.load() / elapsed.count();
+}
+
+int main(int argc, const char * argv[]) {
+
+    if (argc < 2 || argc > 5) {
+        cerr << "ERROR: Invalid number of arguments." << endl;
+        cerr << "Usage: ./benchConcurrent <database file> [max threads] [write percent] [seconds]" << endl;
+        exit(-1);
+    }
+
+    ifstream readf(argv[1]);
+    int max_threads = (argc > 2) ? atoi(argv[2]) : 64;
+    double write_rate = (argc > 3) ? atof(argv[3]) / 100 : 0.01;
+    double seconds = (argc > 4) ? atof(argv[4]) : 0.5;
+    if (readf.fail() || max_threads < 1 || write_rate < 0 || write_rate > 1 || seconds <= 0) {
+        cerr << "ERROR: Invalid file or option. Please check your arguments and try again." << endl;
+        exit(-1);
+    }
+
+    vector<SequenceMap> sites = readSequenceMaps(readf);
+    if (sites.empty()) {
+        cerr << "ERROR: No sequences in database." << endl;
+        exit(-1);
+    }
+
+    // Half the queries are sites, half are sites with an extra base. A write
+    // inserts a query under a new enzyme.
+    vector<SequenceMap> queries;
+    vector<SequenceMap> writes;
+    for (size_t i = 0; i < sites.size(); i++) {
+        string site = sites[i].getSequence();
+        string query = (i % 2 == 0) ? site : site + "A";
+        queries.push_back(SequenceMap(query));
+        writes.push_back(SequenceMap(query, "New" + to_string(i)));
+    }
+
+    cout << "Sequences: " << sites.size() << ", writes: " << write_rate * 100 << "%, "
+         << seconds << " s per run" << endl;
+
+    double concurrent_one = 0;
+    double skip_one = 0;
+    double locked_one = 0;
+    for (int threads = 1; ; threads = min(2 * threads, max_threads)) {
+
+        ConcurrentAvlTree<SequenceMap> concurrent;
+        SkipList<SequenceMap> skip;
+        LockedAvlTree locked;
+        int count = 0;
+        for (const SequenceMap &site : sites) {
+            concurrent.insert(site, count);
+            skip.insert(site, count);
+            locked.insert(site, count);
+        }
+
+        double concurrent_ops = runThreads(concurrent, queries, writes, threads, write_rate, seconds);
+        double skip_ops = runThreads(skip, queries, writes, threads, write_rate, seconds);
+        double locked_ops = runThreads(locked, queries, writes, threads, write_rate, seconds);
+        if (threads == 1) {
+            concurrent_one = concurrent_ops;
+            skip_one = skip_ops;
+            locked_one = locked_ops;
+        }
+
+        cout << "Threads: " << threads
+             << ", ConcurrentAvlTree (Mops/s): " << concurrent_ops / 1e6
+             << " (speedup " << concurrent_ops / concurrent_one << ")"
+             << ", SkipList (Mops/s): " << skip_ops / 1e6
+             << " (speedup " << skip_ops / skip_one << ")"
+             << ", AvlTree with mutex (Mops/s): " << locked_ops / 1e6
+             << " (speedup " << locked_ops / locked_one << ")" << endl;
+
+        if (threads == max_threads) {
+            break;
+        }
+    }
+
+    return 0;
+}
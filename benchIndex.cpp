@@ -0,0 +1,109 @@
+/*****************************************************************************
+ Title:             benchIndex.cpp
+ Created on:        October 18, 2026
+ Description:       Compares lookup speed of AvlTree::contains() with
+                    FrozenSequenceIndex::contains().
+                    1. Parses a given file of enzymes and recognition
+                    sequences.
+                    2. Scales the recognition sequences up to a given number
+                    of distinct keys by appending a suffix of bases to each.
+                    3. Builds an AVL tree and a frozen index over the keys.
+                    4. Times a shuffled mix of hit and miss queries against
+                    both and prints the time per query.
+
+ ****************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+#include "AvlTree.h"
+#include "FrozenSequenceIndex.h"
+#include "TreeParser.h"
+
+using namespace std;
+
+/**
+ * Returns n written in base 4 using the letters A, C, G and T
+ */
+string baseSuffix(size_t n) {
+    string suffix;
+    do {
+        suffix += "ACGT"[n % 4];
+        n /= 4;
+    } while (n > 0);
+    return suffix;
+}
+
+/**
+ * Runs every query against tree and prints the average time per query
+ */
+template <typename TreeType>
+void timeQueries(const string &name, const TreeType &tree, const vector<SequenceMap> &queries) {
+
+    int success = 0;
+    int count = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (const SequenceMap &q : queries) {
+        if (tree.contains(q, count)) {
+            success++;
+        }
+    }
+    chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+
+    cout << name << ": " << elapsed.count() / queries.size() << " ns/query, "
+         << success << " hits, " << count << " levels searched" << endl;
+}
+
+int main(int argc, const char * argv[]) {
+
+    if (argc != 3) {
+        cerr << "ERROR: Invalid number of arguments." << endl;
+        cerr << "Usage: ./benchIndex <database file> <number of keys>" << endl;
+        exit(-1);
+    }
+
+    ifstream readf(argv[1]);
+    if (readf.fail()) {
+        cerr << "ERROR: Invalid file. Please check your file name and try again." << endl;
+        exit(-1);
+    }
+
+    size_t n = strtoul(argv[2], nullptr, 10);
+    vector<SequenceMap> sites = readSequenceMaps(readf);
+    if (sites.empty() || n == 0) {
+        cerr << "ERROR: No keys to index." << endl;
+        exit(-1);
+    }
+
+    // Scale up: key i is site (i mod m) followed by the base 4 digits of i / m
+    vector<SequenceMap> smaps;
+    vector<SequenceMap> queries;
+    smaps.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        const string &site = sites[i % sites.size()].getSequence();
+        string suffix = baseSuffix(i / sites.size());
+        smaps.push_back(SequenceMap(site + suffix, "E" + to_string(i)));
+
+        // Half the queries hit, half miss
+        queries.push_back(SequenceMap(i % 2 == 0 ? site + suffix : site + "N" + suffix));
+    }
+
+    mt19937 rng(210);
+    shuffle(queries.begin(), queries.end(), rng);
+
+    AvlTree<SequenceMap> avl_tree(make_move_iterator(smaps.begin()), make_move_iterator(smaps.end()));
+    FrozenSequenceIndex frozen(avl_tree);
+
+    cout << "Keys: " << frozen.nodes() << ", queries: " << queries.size() << endl;
+    timeQueries("AvlTree", avl_tree, queries);
+    timeQueries("FrozenSequenceIndex", frozen, queries);
+
+    return 0;
+}
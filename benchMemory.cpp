@@ -0,0 +1,96 @@
+/*****************************************************************************
+ Title:             benchMemory.cpp
+ Created on:        October 18, 2026
+ Description:       Measures the heap memory held per node of an AVL tree
+                    and the time taken to load it.
+                    1. Reads a given file of enzymes and recognition
+                    sequences.
+                    2. Scales it up to a given number of copies. Copy k
+                    renames every enzyme and appends a suffix of bases to
+                    its sequences; copies that share a suffix share
+                    sequences, like isoschizomers do.
+                    3. Parses the scaled database into an AVL tree and
+                    prints the load time and the heap bytes held per node
+                    and per (sequence, enzyme) pair.
+
+ ****************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+
+#include "AllocationCounter.h"
+#include "AvlTree.h"
+#include "TreeParser.h"
+
+using namespace std;
+
+// Copies of the database that share each suffix of bases
+static const size_t SHARED_COPIES = 4;
+
+/**
+ * Returns n written in base 4 using the letters A, C, G and T
+ */
+string baseSuffix(size_t n) {
+    string suffix;
+    do {
+        suffix += "ACGT"[n % 4];
+        n /= 4;
+    } while (n > 0);
+    return suffix;
+}
+
+/**
+ * Returns copies of the database in file, one line per enzyme. Copy k names
+ * each enzyme with a suffix of k and appends baseSuffix(k / SHARED_COPIES)
+ * to each of its sequences.
+ */
+string scaleDatabase(const string &file, size_t copies) {
+    string scaled;
+    for (size_t k = 0; k < copies; k++) {
+        string bases = baseSuffix(k / SHARED_COPIES);
+        scanSequenceMaps(file, [&](string_view seq, string_view acronym) {
+            scaled.append(acronym).append("_").append(to_string(k)).append("/");
+            scaled.append(seq).append(bases).append("//\n");
+        });
+    }
+    return scaled;
+}
+
+int main(int argc, const char * argv[]) {
+
+    if (argc != 3) {
+        cerr << "ERROR: Invalid number of arguments." << endl;
+        cerr << "Usage: ./benchMemory <database file> <number of copies>" << endl;
+        exit(-1);
+    }
+
+    ifstream readf(argv[1]);
+    if (readf.fail()) {
+        cerr << "ERROR: Invalid file. Please check your file name and try again." << endl;
+        exit(-1);
+    }
+
+    string database((istreambuf_iterator<char>(readf)), istreambuf_iterator<char>());
+    string scaled = scaleDatabase(database, strtoul(argv[2], nullptr, 10));
+    size_t pairs = 0;
+    scanSequenceMaps(scaled, [&pairs](string_view, string_view) { pairs++; });
+
+    istringstream input(scaled);
+    size_t before = heapBytesInUse();
+    auto start = chrono::steady_clock::now();
+    AvlTree<SequenceMap> tree = parseTree<AvlTree<SequenceMap>>(input);
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    size_t held = heapBytesInUse() - before;
+
+    int nodes = tree.nodes();
+    cout << "Pairs: " << pairs << ", nodes: " << nodes << endl;
+    cout << "Load time (ms): " << elapsed.count() << endl;
+    cout << "Heap bytes held: " << held << " (" << static_cast<double>(held) / nodes
+         << " per node, " << static_cast<double>(held) / pairs << " per pair)" << endl;
+
+    return 0;
+}
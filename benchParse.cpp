@@ -0,0 +1,97 @@
+/*****************************************************************************
+ Title:             benchParse.cpp
+ Created on:        October 18, 2026
+ Description:       Compares parse throughput of reading a database through
+                    an ifstream with scanning it from a MappedFile.
+                    1. Reads a given file of enzymes and recognition
+                    sequences a given number of times with each parser and
+                    prints the throughput in MB/s.
+                    2. Does the same for parseTree(), which also builds an
+                    AVL tree from the sequences.
+                    3. Checks that both parsers give the same trees.
+
+ ****************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "AvlTree.h"
+#include "MappedFile.h"
+#include "TreeParser.h"
+
+using namespace std;
+
+/**
+ * Runs parse repetitions times and prints the throughput over bytes of
+ * input per run. Returns the number of elements the last run produced.
+ */
+template <typename Parse>
+size_t timeParse(const string &name, size_t bytes, int repetitions, Parse parse) {
+    
+    size_t produced = 0;
+    
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; i++) {
+        produced = parse();
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    
+    double megabytes = static_cast<double>(bytes) * repetitions / (1024 * 1024);
+    cout << name << ": " << megabytes / elapsed.count() << " MB/s ("
+         << elapsed.count() * 1000 / repetitions << " ms per run)" << endl;
+    
+    return produced;
+}
+
+int main(int argc, const char * argv[]) {
+    
+    if (argc != 2 && argc != 3) {
+        cerr << "ERROR: Invalid number of arguments." << endl;
+        cerr << "Usage: ./benchParse <database file> [repetitions]" << endl;
+        exit(-1);
+    }
+    
+    string file_name = argv[1];
+    int repetitions = (argc == 3) ? atoi(argv[2]) : 10;
+    
+    MappedFile mapped(file_name);
+    if (mapped.fail() || repetitions <= 0) {
+        cerr << "ERROR: Invalid file. Please check your file name and try again." << endl;
+        exit(-1);
+    }
+    
+    size_t bytes = mapped.size();
+    cout << "File size: " << bytes << " bytes, " << repetitions << " runs" << endl;
+    
+    // Parse only
+    size_t stream_maps = timeParse("readSequenceMaps(ifstream)", bytes, repetitions, [&file_name]() {
+        ifstream readf(file_name.c_str());
+        return readSequenceMaps(readf).size();
+    });
+    size_t mapped_maps = timeParse("readSequenceMaps(MappedFile)", bytes, repetitions, [&mapped]() {
+        return readSequenceMaps(mapped).size();
+    });
+    
+    // Parse and build
+    size_t stream_nodes = timeParse("parseTree(ifstream)", bytes, repetitions, [&file_name]() {
+        ifstream readf(file_name.c_str());
+        return static_cast<size_t>(parseTree<AvlTree<SequenceMap>>(readf).nodes());
+    });
+    size_t mapped_nodes = timeParse("parseTree(MappedFile)", bytes, repetitions, [&mapped]() {
+        return static_cast<size_t>(parseTree<AvlTree<SequenceMap>>(mapped).nodes());
+    });
+    
+    cout << "Sequences parsed: " << stream_maps << " / " << mapped_maps << endl;
+    cout << "Nodes in tree: " << stream_nodes << " / " << mapped_nodes << endl;
+    
+    if (stream_maps != mapped_maps || stream_nodes != mapped_nodes) {
+        cerr << "ERROR: Parsers disagree." << endl;
+        exit(-1);
+    }
+    
+    return 0;
+}
@@ -0,0 +1,126 @@
+/*****************************************************************************
+ Title:             benchPattern.cpp
+ Created on:        October 18, 2026
+ Description:       Compares pattern queries answered by IupacPatternIndex
+                    with a brute-force in-order scan of an AvlTree.
+                    1. Parses a given file of enzymes and recognition
+                    sequences into an AVL tree and a pattern index.
+                    2. Makes a given number of DNA fragments: half are
+                    instances of stored sites with each degenerate symbol
+                    replaced by a random base it stands for, half are random
+                    bases.
+                    3. Times finding the matching sites for every fragment
+                    both ways, prints the time per query and checks that
+                    both find the same sites.
+
+ ****************************************************************************/
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+
+#include "AvlTree.h"
+#include "IupacPatternIndex.h"
+#include "MappedFile.h"
+#include "TreeParser.h"
+
+using namespace std;
+
+/**
+ * Returns a random base that the IUPAC symbol c stands for
+ */
+char randomBase(char c, mt19937 &rng) {
+    string bases;
+    for (char base : string("ACGT")) {
+        if (IupacPatternIndex::matches(string(1, c), string(1, base))) {
+            bases += base;
+        }
+    }
+    return bases.empty() ? 'A' : bases[rng() % bases.size()];
+}
+
+int main(int argc, const char * argv[]) {
+    
+    if (argc != 3) {
+        cerr << "ERROR: Invalid number of arguments." << endl;
+        cerr << "Usage: ./benchPattern <database file> <number of queries>" << endl;
+        exit(-1);
+    }
+    
+    MappedFile readf(argv[1]);
+    if (readf.fail()) {
+        cerr << "ERROR: Invalid file. Please check your file name and try again." << endl;
+        exit(-1);
+    }
+    
+    AvlTree<SequenceMap> avl_tree = parseTree<AvlTree<SequenceMap>>(readf);
+    IupacPatternIndex index(avl_tree);
+    
+    vector<string> sites;
+    avl_tree.inOrder([&sites](const SequenceMap &x) { sites.push_back(x.getSequence()); });
+    
+    size_t n = strtoul(argv[2], nullptr, 10);
+    if (sites.empty() || n == 0) {
+        cerr << "ERROR: No queries to run." << endl;
+        exit(-1);
+    }
+    
+    // Half the fragments are instances of a site, half random bases
+    mt19937 rng(210);
+    vector<string> fragments;
+    for (size_t i = 0; i < n; i++) {
+        const string &site = sites[rng() % sites.size()];
+        string fragment;
+        for (char c : site) {
+            if (c != '\'') {
+                fragment += (i % 2 == 0) ? randomBase(c, rng) : "ACGT"[rng() % 4];
+            }
+        }
+        fragments.push_back(fragment);
+    }
+    
+    // Brute force: test every site against every fragment
+    long scan_matches = 0;
+    vector<size_t> scan_counts;
+    auto start = chrono::steady_clock::now();
+    for (const string &fragment : fragments) {
+        size_t found = 0;
+        avl_tree.inOrder([&found, &fragment](const SequenceMap &x) {
+            if (IupacPatternIndex::matches(x.getSequence(), fragment)) {
+                found++;
+            }
+        });
+        scan_counts.push_back(found);
+        scan_matches += found;
+    }
+    chrono::duration<double, nano> scan_time = chrono::steady_clock::now() - start;
+    
+    // Trie
+    long index_matches = 0;
+    int visited = 0;
+    bool agree = true;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < fragments.size(); i++) {
+        size_t found = index.match(fragments[i], visited).size();
+        agree = agree && found == scan_counts[i];
+        index_matches += found;
+    }
+    chrono::duration<double, nano> index_time = chrono::steady_clock::now() - start;
+    
+    cout << "Sites: " << index.sites() << ", trie nodes: " << index.trieNodes()
+         << ", queries: " << fragments.size() << endl;
+    cout << "AvlTree in-order scan: " << scan_time.count() / n << " ns/query, "
+         << scan_matches << " matches" << endl;
+    cout << "IupacPatternIndex: " << index_time.count() / n << " ns/query, "
+         << index_matches << " matches, " << visited << " trie nodes visited" << endl;
+    
+    if (!agree) {
+        cerr << "ERROR: Scan and index disagree." << endl;
+        exit(-1);
+    }
+    
+    return 0;
+}
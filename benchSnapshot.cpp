@@ -0,0 +1,122 @@
+/*****************************************************************************
+ Title:             benchSnapshot.cpp
+ Created on:        October 18, 2026
+ Description:       Compares the startup time of parsing a database into a
+                    tree with loading the tree from a snapshot.
+                    1. Parses a given file of enzymes and recognition
+                    sequences into an AVL tree and saves it to a given
+                    snapshot file, with and without its shape.
+                    2. Times parseTree() against load() from each snapshot,
+                    for an AVL tree and a binary search tree, a given number
+                    of times.
+                    3. Checks that the loaded trees are the same as the
+                    parsed ones.
+
+ ****************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+#include <chrono>
+
+#include "AvlTree.h"
+#include "BinarySearchTree.h"
+#include "MappedFile.h"
+#include "TreeParser.h"
+
+using namespace std;
+
+/**
+ * Runs start repetitions times and prints the time per run. Returns the
+ * time per run in ms.
+ */
+template <typename Start>
+double timeStartup(const string &name, int repetitions, Start start) {
+
+    auto begin = chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; i++) {
+        start();
+    }
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - begin;
+
+    double per_run = elapsed.count() / repetitions;
+    cout << name << ": " << per_run << " ms per run" << endl;
+    return per_run;
+}
+
+/**
+ * Returns the contents of the file at path
+ */
+string readFile(const string &path) {
+    ifstream readf(path.c_str(), ios::binary);
+    return string((istreambuf_iterator<char>(readf)), istreambuf_iterator<char>());
+}
+
+/**
+ * Times parsing file into a TreeType against loading it from the snapshot
+ * at path, and checks that saving the loaded tree gives the same snapshot.
+ * Returns false if the trees differ.
+ */
+template <typename TreeType>
+bool compareStartup(const string &name, const MappedFile &file, const string &path, bool shape, int repetitions) {
+
+    TreeType parsed = parseTree<TreeType>(file);
+    if (!parsed.save(path, shape)) {
+        cerr << "ERROR: Could not write snapshot " << path << endl;
+        exit(-1);
+    }
+
+    double parse_ms = timeStartup(name + " parseTree()", repetitions, [&file]() {
+        parseTree<TreeType>(file);
+    });
+    double load_ms = timeStartup(name + " load()" + (shape ? "" : " without shape"), repetitions, [&path]() {
+        TreeType tree;
+        tree.load(path);
+    });
+    cout << "Speedup: " << parse_ms / load_ms << "x" << endl;
+
+    TreeType loaded;
+    string resaved = path + ".check";
+    bool same = loaded.load(path) && loaded.save(resaved, shape) &&
+                readFile(path) == readFile(resaved) && loaded.nodes() == parsed.nodes();
+    if (shape) {
+        same = same && loaded.internalPathLength() == parsed.internalPathLength();
+    }
+    remove(resaved.c_str());
+    return same;
+}
+
+int main(int argc, const char * argv[]) {
+
+    if (argc != 3 && argc != 4) {
+        cerr << "ERROR: Invalid number of arguments." << endl;
+        cerr << "Usage: ./benchSnapshot <database file> <snapshot file> [repetitions]" << endl;
+        exit(-1);
+    }
+
+    string file_name = argv[1];
+    string snapshot = argv[2];
+    int repetitions = (argc == 4) ? atoi(argv[3]) : 10;
+
+    MappedFile mapped(file_name);
+    if (mapped.fail() || repetitions <= 0) {
+        cerr << "ERROR: Invalid file. Please check your file name and try again." << endl;
+        exit(-1);
+    }
+
+    bool same = compareStartup<AvlTree<SequenceMap>>("AVL", mapped, snapshot, true, repetitions);
+    cout << "Snapshot size: " << readFile(snapshot).size() << " bytes (database "
+         << mapped.size() << " bytes)" << endl;
+    same = compareStartup<AvlTree<SequenceMap>>("AVL", mapped, snapshot, false, repetitions) && same;
+    same = compareStartup<BinarySearchTree<SequenceMap>>("BST", mapped, snapshot, true, repetitions) && same;
+    remove(snapshot.c_str());
+
+    if (!same) {
+        cerr << "ERROR: Loaded tree differs from parsed tree." << endl;
+        exit(-1);
+    }
+
+    return 0;
+}
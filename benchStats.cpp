@@ -0,0 +1,166 @@
+/*****************************************************************************
+ Title:             benchStats.cpp
+ Created on:        October 18, 2026
+ Description:       Shows that the tree characteristics of the AVL trees
+                    cost the same at any size.
+                    1. Parses a given file of enzymes and recognition
+                    sequences.
+                    2. Scales the recognition sequences up to 1000, 10000,
+                    ... up to a given number of distinct keys by appending
+                    a suffix of bases to each, and shuffles them.
+                    3. Inserts the keys into an AVL tree, an AVL tree with
+                    lazy deletion (removing every other key) and a binary
+                    search tree, which still counts its nodes by walking
+                    them.
+                    4. Prints, for each size, the time per call of
+                    getTreeCharacteristics() on each tree, and of rank()
+                    and select() on the AVL trees.
+
+ ****************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+#include "AvlTree.h"
+#include "LazyAVLTree.h"
+#include "BinarySearchTree.h"
+#include "TestRoutines.h"
+#include "TreeParser.h"
+
+using namespace std;
+
+// Each measurement repeats until it has run this long
+static const chrono::milliseconds MIN_TIME(50);
+
+/**
+ * Returns n written in base 4 using the letters A, C, G and T
+ */
+string baseSuffix(size_t n) {
+    string suffix;
+    do {
+        suffix += "ACGT"[n % 4];
+        n /= 4;
+    } while (n > 0);
+    return suffix;
+}
+
+/**
+ * Calls op(i) for i = 0, 1, ... until MIN_TIME has passed and returns the
+ * average time per call in ns
+ */
+template <typename Operation>
+double timePerCall(Operation op) {
+    size_t calls = 0;
+    auto start = chrono::steady_clock::now();
+    chrono::duration<double, nano> elapsed(0);
+    do {
+        for (size_t i = 0; i < 64; i++) {
+            op(calls++);
+        }
+        elapsed = chrono::steady_clock::now() - start;
+    } while (elapsed < MIN_TIME);
+    return elapsed.count() / calls;
+}
+
+/**
+ * Returns the time per call of getTreeCharacteristics(tree) in ns, with its
+ * report thrown away
+ */
+template <typename TreeType>
+double characteristicsTime(TreeType &tree) {
+    ofstream null_stream;
+    streambuf *console = cout.rdbuf(null_stream.rdbuf());
+    double ns = timePerCall([&tree](size_t) { getTreeCharacteristics(tree); });
+    cout.rdbuf(console);
+    return ns;
+}
+
+/**
+ * Returns the time per call of rank() and of select() on tree in ns, for
+ * keys taken in turn from queries
+ */
+template <typename TreeType>
+pair<double, double> orderStatisticTimes(const TreeType &tree, int live,
+                                         const vector<SequenceMap> &queries) {
+    int sink = 0;
+    double rank_ns = timePerCall([&](size_t i) {
+        sink += tree.rank(queries[i % queries.size()]);
+    });
+    double select_ns = timePerCall([&](size_t i) {
+        sink += tree.select(static_cast<int>(i * 7919 % live)).getSequence().size();
+    });
+    if (sink == -1) {
+        cout << endl;   // Keeps the calls from being optimized away
+    }
+    return make_pair(rank_ns, select_ns);
+}
+
+int main(int argc, const char * argv[]) {
+
+    if (argc != 3) {
+        cerr << "ERROR: Invalid number of arguments." << endl;
+        cerr << "Usage: ./benchStats <database file name> <max number of keys>" << endl;
+        exit(-1);
+    }
+
+    ifstream readf(argv[1]);
+    if (readf.fail()) {
+        cerr << "ERROR: Invalid file. Please check your file name and try again." << endl;
+        exit(-1);
+    }
+
+    size_t max_n = strtoul(argv[2], nullptr, 10);
+    vector<SequenceMap> sites = readSequenceMaps(readf);
+    if (sites.empty() || max_n < 1000) {
+        cerr << "ERROR: Need a database and at least 1000 keys." << endl;
+        exit(-1);
+    }
+
+    cout << "keys,avl_stats_ns,lazy_avl_stats_ns,bst_stats_ns,"
+         << "avl_rank_ns,avl_select_ns,lazy_avl_rank_ns,lazy_avl_select_ns" << endl;
+
+    mt19937 rng(210);
+    for (size_t n = 1000; n <= max_n; n *= 10) {
+
+        // Key i is site (i mod m) followed by the base 4 digits of i / m
+        vector<SequenceMap> smaps;
+        smaps.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            const string &site = sites[i % sites.size()].getSequence();
+            smaps.push_back(SequenceMap(site + baseSuffix(i / sites.size()), "E" + to_string(i)));
+        }
+        shuffle(smaps.begin(), smaps.end(), rng);
+
+        int count = 0;
+        AvlTree<SequenceMap> avl_tree;
+        LazyAvlTree<SequenceMap> lazy_tree;
+        BinarySearchTree<SequenceMap> bs_tree;
+        lazy_tree.setCompactionThreshold(1);
+        for (size_t i = 0; i < n; i++) {
+            avl_tree.insert(smaps[i], count);
+            lazy_tree.insert(smaps[i], count);
+            bs_tree.insert(smaps[i], count);
+        }
+        for (size_t i = 0; i < n; i += 2) {
+            lazy_tree.remove(smaps[i], count);
+        }
+
+        pair<double, double> avl_times = orderStatisticTimes(avl_tree, avl_tree.nodes(), smaps);
+        pair<double, double> lazy_times = orderStatisticTimes(lazy_tree, lazy_tree.liveNodes(), smaps);
+
+        cout << avl_tree.nodes() << ","
+             << characteristicsTime(avl_tree) << ","
+             << characteristicsTime(lazy_tree) << ","
+             << characteristicsTime(bs_tree) << ","
+             << avl_times.first << "," << avl_times.second << ","
+             << lazy_times.first << "," << lazy_times.second << endl;
+    }
+
+    return 0;
+}
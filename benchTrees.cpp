@@ -0,0 +1,393 @@
+/*****************************************************************************
+ Title:             benchTrees.cpp
+ Created on:        October 18, 2026
+ Description:       Microbenchmarks of the binary search tree, the AVL tree
+                    and the AVL tree with lazy deletion.
+                    1. Makes random keys of a given length over A, C, G and
+                    T, and a second set of keys that are not in the tree.
+                    2. For every tree, number of keys n, key distribution
+                    and key length, times:
+                        - insert: building the tree with n inserts
+                        - hit: n contains() of keys in the tree
+                        - miss: n contains() of keys not in the tree
+                        - remove: n removes from a full tree
+                        - mixed: 90% contains(), 5% insert and 5% remove
+                    Keys are used in random order, in sorted order or drawn
+                    from a Zipfian distribution, so a few keys are used far
+                    more often than the rest.
+                    3. Prints ns, cycles and heap allocations per operation
+                    of each benchmark as CSV, or as JSON with --json.
+
+                    Each benchmark is repeated until it has run for at least
+                    --min-time seconds; only the operations are timed, not
+                    building or emptying the tree between repetitions.
+                    Cycles are read from the time stamp counter, so they
+                    count at its fixed rate, and are 0 where there is none.
+
+ ****************************************************************************/
+
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "AllocationCounter.h"
+#include "AvlTree.h"
+#include "LazyAVLTree.h"
+#include "BinarySearchTree.h"
+
+using namespace std;
+
+// Parameters swept when no limits are given
+static const size_t SIZES[] = {1000, 10000, 100000, 1000000, 10000000};
+static const size_t KEY_LENGTHS[] = {16, 32, 64};
+static const char *DISTRIBUTIONS[] = {"random", "sorted", "zipf"};
+
+// Exponent of the Zipfian distribution
+static const double ZIPF_EXPONENT = 0.99;
+
+// Inserting sorted keys makes a binary search tree a list, so it is only
+// run up to this many keys
+static const size_t MAX_SORTED_BST = 10000;
+
+// A benchmark stops repeating after this many times --min-time, counting
+// the untimed setup between repetitions
+static const double SETUP_LIMIT = 5;
+
+/**
+ * Result of one benchmark, per operation
+ */
+struct BenchResult {
+    string tree;
+    string operation;
+    size_t n;
+    string distribution;
+    size_t keyLength;
+    size_t operations;          // Operations timed over all repetitions
+    double ns;
+    double cycles;
+    double allocations;
+};
+
+/**
+ * Returns the time stamp counter, or 0 where there is none
+ */
+inline uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Times repetitions of run, which performs some operations and returns how
+ * many, until minTime seconds have been spent in it. setup is called before
+ * each repetition and is not timed, but stops the repetitions early if it
+ * takes most of the time.
+ */
+template <typename Setup, typename Run>
+BenchResult measure(double minTime, Setup setup, Run run) {
+
+    BenchResult result = BenchResult();
+    chrono::duration<double> spent(0);
+    uint64_t cycles = 0;
+    long allocations = 0;
+    auto begin = chrono::steady_clock::now();
+    do {
+        setup();
+        long allocationsBefore = heapAllocations();
+        uint64_t cyclesBefore = readCycles();
+        auto start = chrono::steady_clock::now();
+        result.operations += run();
+        spent += chrono::steady_clock::now() - start;
+        cycles += readCycles() - cyclesBefore;
+        allocations += heapAllocations() - allocationsBefore;
+    } while (spent.count() < minTime &&
+             chrono::steady_clock::now() - begin < chrono::duration<double>(SETUP_LIMIT * minTime));
+
+    double ops = static_cast<double>(max<size_t>(result.operations, 1));
+    result.ns = spent.count() * 1e9 / ops;
+    result.cycles = cycles / ops;
+    result.allocations = allocations / ops;
+    return result;
+}
+
+/**
+ * Returns count distinct random keys of the given length, in random order
+ */
+vector<SequenceMap> randomKeys(size_t count, size_t length, mt19937_64 &random) {
+
+    vector<SequenceMap> keys;
+    string seq(length, 'A');
+    while (keys.size() < count) {
+        while (keys.size() < count + count / 16 + 16) {
+            for (char &base : seq) {
+                base = "ACGT"[random() & 3];
+            }
+            keys.emplace_back(seq, "Bench");
+        }
+        sort(keys.begin(), keys.end());
+        keys.erase(unique(keys.begin(), keys.end(), [](const SequenceMap &a, const SequenceMap &b) {
+            return a.compare(b) == 0;
+        }), keys.end());
+    }
+    shuffle(keys.begin(), keys.end(), random);
+    keys.erase(keys.begin() + count, keys.end());
+    return keys;
+}
+
+/**
+ * Draws indexes into n keys, where index i is drawn with probability
+ * proportional to 1 / (i + 1)^ZIPF_EXPONENT
+ */
+class ZipfSampler {
+public:
+
+    explicit ZipfSampler(size_t n):cumulative(n) {
+        double total = 0;
+        for (size_t i = 0; i < n; i++) {
+            total += 1.0 / pow(static_cast<double>(i + 1), ZIPF_EXPONENT);
+            cumulative[i] = total;
+        }
+    }
+
+    size_t operator() (mt19937_64 &random) const {
+        double u = uniform_real_distribution<double>(0, cumulative.back())(random);
+        size_t i = lower_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin();
+        return min(i, cumulative.size() - 1);
+    }
+
+private:
+
+    vector<double> cumulative;
+};
+
+/**
+ * Returns the order in which to use the n keys of pool: all of them
+ * shuffled, all of them sorted, or n Zipfian draws. Popular keys are
+ * scattered over the key space, since pool is in random order.
+ */
+vector<const SequenceMap *> keyOrder(const vector<SequenceMap> &pool, const string &distribution,
+                                     const ZipfSampler &zipf, mt19937_64 &random) {
+
+    vector<const SequenceMap *> order;
+    order.reserve(pool.size());
+    if (distribution == "zipf") {
+        for (size_t i = 0; i < pool.size(); i++) {
+            order.push_back(&pool[zipf(random)]);
+        }
+        return order;
+    }
+    for (const SequenceMap &key : pool) {
+        order.push_back(&key);
+    }
+    if (distribution == "random") {
+        shuffle(order.begin(), order.end(), random);
+    }
+    else if (distribution == "sorted") {
+        sort(order.begin(), order.end(), [](const SequenceMap *a, const SequenceMap *b) {
+            return a->compare(*b) < 0;
+        });
+    }
+    return order;
+}
+
+/**
+ * Runs every benchmark for one tree type, n, distribution and key length
+ */
+template <typename TreeType>
+void benchTree(const string &name, const vector<SequenceMap> &keys, const vector<SequenceMap> &missing,
+               const string &distribution, size_t keyLength, double minTime, vector<BenchResult> &results) {
+
+    mt19937_64 random(keys.size() * 31 + keyLength);
+    ZipfSampler zipf(keys.size());
+    vector<const SequenceMap *> order = keyOrder(keys, distribution, zipf, random);
+    vector<const SequenceMap *> queries = keyOrder(keys, distribution, zipf, random);
+    vector<const SequenceMap *> misses = keyOrder(missing, distribution, zipf, random);
+
+    // Recursive calls are not reported, so count is reset before each pass
+    // over the keys to keep it from overflowing
+    int count = 0;
+    TreeType tree;
+    auto build = [&tree, &order, &count]() {
+        tree.makeEmpty();
+        count = 0;
+        for (const SequenceMap *key : order) {
+            tree.insert(*key, count);
+        }
+    };
+    auto lookup = [&tree, &count](const vector<const SequenceMap *> &keys) {
+        size_t found = 0;
+        count = 0;
+        for (const SequenceMap *key : keys) {
+            found += tree.contains(*key, count);
+        }
+        // Keeps the lookups from being optimised away
+        if (found > keys.size()) {
+            cerr << found;
+        }
+        return keys.size();
+    };
+
+    // Mixed operations on one tree, which drifts as keys come and go
+    vector<pair<char, const SequenceMap *>> mixed;
+    for (size_t i = 0; i < order.size(); i++) {
+        unsigned roll = random() % 20;
+        if (roll == 0) {
+            mixed.push_back(make_pair('i', misses[i]));
+        }
+        else if (roll == 1) {
+            mixed.push_back(make_pair('r', queries[i]));
+        }
+        else {
+            mixed.push_back(make_pair('c', queries[i]));
+        }
+    }
+
+    vector<BenchResult> run;
+    run.push_back(measure(minTime, [&tree]() { tree.makeEmpty(); }, [&]() {
+        count = 0;
+        for (const SequenceMap *key : order) {
+            tree.insert(*key, count);
+        }
+        return order.size();
+    }));
+    run.back().operation = "insert";
+
+    build();
+    run.push_back(measure(minTime, []() { }, [&]() { return lookup(queries); }));
+    run.back().operation = "hit";
+    run.push_back(measure(minTime, []() { }, [&]() { return lookup(misses); }));
+    run.back().operation = "miss";
+
+    run.push_back(measure(minTime, build, [&]() {
+        count = 0;
+        for (const SequenceMap *key : order) {
+            tree.remove(*key, count);
+        }
+        return order.size();
+    }));
+    run.back().operation = "remove";
+
+    build();
+    run.push_back(measure(minTime, []() { }, [&]() {
+        size_t found = 0;
+        count = 0;
+        for (const pair<char, const SequenceMap *> &op : mixed) {
+            if (op.first == 'c') {
+                found += tree.contains(*op.second, count);
+            }
+            else if (op.first == 'i') {
+                tree.insert(*op.second, count);
+            }
+            else {
+                tree.remove(*op.second, count);
+            }
+        }
+        if (found > mixed.size()) {
+            cerr << found;
+        }
+        return mixed.size();
+    }));
+    run.back().operation = "mixed";
+
+    for (BenchResult &result : run) {
+        result.tree = name;
+        result.n = keys.size();
+        result.distribution = distribution;
+        result.keyLength = keyLength;
+        results.push_back(result);
+    }
+}
+
+/**
+ * Prints results as CSV, with a header line
+ */
+void printCsv(const vector<BenchResult> &results) {
+    cout << "tree,operation,n,distribution,key_length,operations,ns_per_op,cycles_per_op,allocations_per_op" << endl;
+    for (const BenchResult &r : results) {
+        cout << r.tree << "," << r.operation << "," << r.n << "," << r.distribution << ","
+             << r.keyLength << "," << r.operations << "," << r.ns << "," << r.cycles << ","
+             << r.allocations << endl;
+    }
+}
+
+/**
+ * Prints results as a JSON array of objects
+ */
+void printJson(const vector<BenchResult> &results) {
+    cout << "[" << endl;
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        cout << "  {\"tree\": \"" << r.tree << "\", \"operation\": \"" << r.operation
+             << "\", \"n\": " << r.n << ", \"distribution\": \"" << r.distribution
+             << "\", \"key_length\": " << r.keyLength << ", \"operations\": " << r.operations
+             << ", \"ns_per_op\": " << r.ns << ", \"cycles_per_op\": " << r.cycles
+             << ", \"allocations_per_op\": " << r.allocations << "}"
+             << (i + 1 < results.size() ? "," : "") << endl;
+    }
+    cout << "]" << endl;
+}
+
+int main(int argc, const char * argv[]) {
+
+    size_t max_n = 100000;
+    double min_time = 0.05;
+    bool json = false;
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--max-n" && i + 1 < argc && atol(argv[i + 1]) > 0) {
+            max_n = atol(argv[++i]);
+        }
+        else if (option == "--min-time" && i + 1 < argc && atof(argv[i + 1]) >= 0) {
+            min_time = atof(argv[++i]);
+        }
+        else if (option == "--json") {
+            json = true;
+        }
+        else {
+            cerr << "ERROR: Invalid option " << option << endl;
+            cerr << "Usage: ./benchTrees [--max-n N] [--min-time SECONDS] [--json]" << endl;
+            exit(-1);
+        }
+    }
+
+    vector<BenchResult> results;
+    for (size_t n : SIZES) {
+        if (n > max_n) {
+            break;
+        }
+        for (size_t length : KEY_LENGTHS) {
+            mt19937_64 random(n + length);
+            vector<SequenceMap> keys = randomKeys(2 * n, length, random);
+            vector<SequenceMap> missing(make_move_iterator(keys.begin() + n), make_move_iterator(keys.end()));
+            keys.erase(keys.begin() + n, keys.end());
+
+            for (const char *distribution : DISTRIBUTIONS) {
+                benchTree<AvlTree<SequenceMap>>("AVL", keys, missing, distribution, length, min_time, results);
+                benchTree<LazyAvlTree<SequenceMap>>("LazyAVL", keys, missing, distribution, length, min_time, results);
+                if (string(distribution) != "sorted" || n <= MAX_SORTED_BST) {
+                    benchTree<BinarySearchTree<SequenceMap>>("BST", keys, missing, distribution, length, min_time, results);
+                }
+            }
+        }
+    }
+
+    if (json) {
+        printJson(results);
+    }
+    else {
+        printCsv(results);
+    }
+
+    return 0;
+}
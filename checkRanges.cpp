@@ -0,0 +1,78 @@
+/*****************************************************************************
+ Title:             checkRanges.cpp
+ Description:       Regression checks for the range queries of the binary
+                    trees, run by make check.
+                    1. Builds a BST, an AVL tree and an AVL tree with lazy
+                    deletion from a few sequences.
+                    2. Checks that range( lo, hi ) lists the sequences from
+                    lo to hi, and nothing when hi is less than lo.
+                    3. Prints each failure and exits with -1 if there was
+                    one.
+
+ ****************************************************************************/
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "AvlTree.h"
+#include "BinarySearchTree.h"
+#include "LazyAVLTree.h"
+#include "SequenceMap.h"
+
+using namespace std;
+
+/**
+ * Returns the sequences in tree.range(lo, hi), in the order listed
+ */
+template <typename TreeType>
+vector<string> rangeOf(const TreeType &tree, const string &lo, const string &hi) {
+    vector<string> found;
+    for (const SequenceMap &s : tree.range(SequenceMap(lo, ""), SequenceMap(hi, ""))) {
+        found.push_back(s.getSequence());
+    }
+    return found;
+}
+
+/**
+ * Checks the ranges of tree, named name. Returns the number of failures
+ */
+template <typename TreeType>
+int checkRanges(const string &name, TreeType &tree) {
+    const vector<string> sequences = { "AAAA", "CCCC", "GGGG", "GTTT", "TTTT" };
+    int count = 0;
+    for (const string &seq : sequences) {
+        tree.insert(SequenceMap(seq, "E"), count);
+    }
+
+    int failures = 0;
+    if (rangeOf(tree, "CCCC", "GTTT") != vector<string>{ "CCCC", "GGGG", "GTTT" }) {
+        cout << name << ": range(CCCC, GTTT) is not CCCC, GGGG, GTTT" << endl;
+        failures++;
+    }
+    if (!rangeOf(tree, "TTTT", "CCCC").empty()) {
+        cout << name << ": range(TTTT, CCCC) is not empty" << endl;
+        failures++;
+    }
+    if (!tree.range(SequenceMap("TTTT", ""), SequenceMap("CCCC", "")).empty()) {
+        cout << name << ": range(TTTT, CCCC).empty() is false" << endl;
+        failures++;
+    }
+    return failures;
+}
+
+int main() {
+
+    BinarySearchTree<SequenceMap> bs_tree;
+    AvlTree<SequenceMap> avl_tree;
+    LazyAvlTree<SequenceMap> lazy_tree;
+
+    int failures = checkRanges("BST", bs_tree) + checkRanges("AVL", avl_tree) +
+                   checkRanges("LazyAVL", lazy_tree);
+    if (failures > 0) {
+        exit(-1);
+    }
+    cout << "Range checks passed." << endl;
+    return 0;
+}
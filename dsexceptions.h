@@ -7,5 +7,6 @@ class ArrayIndexOutOfBoundsException { };
 class IteratorOutOfBoundsException { };
 class IteratorMismatchException { };
 class IteratorUninitializedException { };
+class CapacityException { };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,323 @@
+/*****************************************************************************
+ Title:             genRebase.cpp
+ Created on:        October 18, 2026
+ Description:       Generates a synthetic database of enzymes and recognition
+                    sequences in the REBASE staden format read by the other
+                    programs, and a matching file of queries with one
+                    sequence per line, for testing at scale.
+                    1. Writes a given number of enzymes, each with one
+                    recognition sequence or, at a given rate, two.
+                    Sequence lengths follow a given distribution, each base
+                    is an IUPAC degenerate symbol at a given rate and most
+                    sequences have a ' cut marker.
+                    2. At a given rate, gives an enzyme the sequence of an
+                    earlier one, as isoschizomers share sequences, and
+                    repeats the record of an earlier enzyme.
+                    3. Writes a given number of queries, of which a given
+                    fraction are sequences in the database. The others hold
+                    two cut markers, which no generated sequence does, so
+                    they are never found.
+
+                    Every sequence is worked out from the seed and its
+                    index alone, so the output depends only on the options
+                    and the generator needs no memory for what it has
+                    written, however many enzymes it writes.
+
+ ****************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+// Lengths and weights of recognition sequences, roughly as in REBASE
+static const char *DEFAULT_LENGTHS = "4:8,5:8,6:33,7:6,8:4,10:5,11:6,12:3,13:2,17:3,18:2,24:4,25:3,26:3";
+
+// Degenerate IUPAC symbols, with N the most common as in REBASE
+static const char DEGENERATE[] = "NNNNNNRYKMSWBDHV";
+
+// Bytes written to a file at a time
+static const size_t WRITE_BYTES = 1 << 20;
+
+/**
+ * Options of the generator
+ */
+struct GeneratorOptions {
+    uint64_t seed = 1;
+    uint64_t enzymes = 0;
+    uint64_t queries = 0;
+    double hitRate = 0.5;
+    double degeneracy = 0.05;
+    double cutRate = 0.9;
+    double secondSiteRate = 0.3;
+    double isoschizomerRate = 0.3;
+    double duplicateRate = 0.01;
+    vector<pair<size_t, double>> lengths;   // Length and its cumulative weight
+};
+
+/**
+ * Random numbers for one sequence, seeded from the generator's seed and the
+ * sequence's index, so any sequence can be made again without the ones
+ * before it
+ */
+class SiteRandom {
+public:
+
+    SiteRandom(uint64_t seed, uint64_t index, uint64_t stream)
+        :state(seed * 0x9E3779B97F4A7C15ULL ^ index * 0xD1B54A32D192ED03ULL ^ stream * 0xAEF17502108EF2D9ULL) {
+        next();
+    }
+
+    // Returns the next 64 random bits (splitmix64)
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Returns a number in [0, 1)
+    double uniform() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Returns a number in [0, n)
+    uint64_t below(uint64_t n) {
+        return n == 0 ? 0 : next() % n;
+    }
+
+private:
+
+    uint64_t state;
+};
+
+// Streams of random numbers drawn for each index
+enum Stream { FIRST_SITE, SECOND_SITE, ENZYME, QUERY };
+
+/**
+ * Returns the acronym of enzyme e: a capital, a unique run of lower case
+ * letters and a Roman numeral, like AatII
+ */
+string enzymeName(uint64_t e) {
+    static const char *NUMERALS[] = {"I", "II", "III", "IV", "V", "VI", "VII", "VIII"};
+    // Letters count from aaa, which is 703 in bijective base 26
+    string letters;
+    for (uint64_t n = e / 8 + 703; n > 0; n = (n - 1) / 26) {
+        letters.insert(letters.begin(), static_cast<char>('a' + (n - 1) % 26));
+    }
+    letters[0] = static_cast<char>(letters[0] - 'a' + 'A');
+    return letters + NUMERALS[e % 8];
+}
+
+/**
+ * Returns a new random recognition sequence, with cuts cut markers
+ */
+string randomSite(const GeneratorOptions &options, SiteRandom &random, int cuts) {
+
+    double pick = random.uniform() * options.lengths.back().second;
+    size_t length = options.lengths.back().first;
+    for (const pair<size_t, double> &weight : options.lengths) {
+        if (pick < weight.second) {
+            length = weight.first;
+            break;
+        }
+    }
+
+    string site;
+    for (size_t i = 0; i < length; i++) {
+        if (random.uniform() < options.degeneracy) {
+            site += DEGENERATE[random.below(sizeof(DEGENERATE) - 1)];
+        }
+        else {
+            site += "ACGT"[random.next() & 3];
+        }
+    }
+
+    for (int i = 0; i < cuts; i++) {
+        site.insert(site.begin() + random.below(site.size() + 1), '\'');
+    }
+    return site;
+}
+
+/**
+ * Returns the first recognition sequence of enzyme e. An isoschizomer takes
+ * the sequence of an earlier enzyme, which may itself be one, so the chain
+ * is followed back to the enzyme whose sequence it is.
+ */
+string firstSite(const GeneratorOptions &options, uint64_t e) {
+    while (true) {
+        SiteRandom random(options.seed, e, FIRST_SITE);
+        if (e > 0 && random.uniform() < options.isoschizomerRate) {
+            e = random.below(e);
+            continue;
+        }
+        return randomSite(options, random, random.uniform() < options.cutRate ? 1 : 0);
+    }
+}
+
+/**
+ * Returns the record of enzyme e, without its line break
+ */
+string enzymeRecord(const GeneratorOptions &options, uint64_t e) {
+    string record = enzymeName(e) + "/" + firstSite(options, e) + "/";
+    SiteRandom random(options.seed, e, SECOND_SITE);
+    if (random.uniform() < options.secondSiteRate) {
+        record += randomSite(options, random, random.uniform() < options.cutRate ? 1 : 0) + "/";
+    }
+    return record + "/";
+}
+
+/**
+ * Appends line to buffer and writes buffer to out once it is large
+ */
+void writeLine(ofstream &out, string &buffer, const string &line) {
+    buffer += line;
+    buffer += '\n';
+    if (buffer.size() >= WRITE_BYTES) {
+        out.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
+
+/**
+ * Parses a list of length:weight pairs into options.lengths. Returns false
+ * if the list is not valid.
+ */
+bool parseLengths(const string &list, GeneratorOptions &options) {
+    options.lengths.clear();
+    double total = 0;
+    size_t start = 0;
+    while (start < list.size()) {
+        size_t comma = list.find(',', start);
+        if (comma == string::npos) {
+            comma = list.size();
+        }
+        string item = list.substr(start, comma - start);
+        size_t colon = item.find(':');
+        if (colon == string::npos) {
+            return false;
+        }
+        long length = atol(item.substr(0, colon).c_str());
+        double weight = atof(item.substr(colon + 1).c_str());
+        if (length <= 0 || weight < 0) {
+            return false;
+        }
+        total += weight;
+        options.lengths.push_back(make_pair(static_cast<size_t>(length), total));
+        start = comma + 1;
+    }
+    return !options.lengths.empty() && total > 0;
+}
+
+int main(int argc, const char * argv[]) {
+
+    GeneratorOptions options;
+    bool valid_options = argc >= 4 && atoll(argv[3]) > 0 && parseLengths(DEFAULT_LENGTHS, options);
+    if (valid_options) {
+        options.enzymes = atoll(argv[3]);
+        options.queries = options.enzymes;
+    }
+    auto rate = [](const char *value, double &to) {
+        to = atof(value);
+        return to >= 0 && to <= 1;
+    };
+    for (int i = 4; valid_options && i < argc; i++) {
+        string option = argv[i];
+        bool has_value = i + 1 < argc;
+        if (option == "--seed" && has_value) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (option == "--queries" && has_value) {
+            options.queries = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (option == "--hit-rate" && has_value) {
+            valid_options = rate(argv[++i], options.hitRate);
+        }
+        else if (option == "--degeneracy" && has_value) {
+            valid_options = rate(argv[++i], options.degeneracy);
+        }
+        else if (option == "--cut-rate" && has_value) {
+            valid_options = rate(argv[++i], options.cutRate);
+        }
+        else if (option == "--second-site-rate" && has_value) {
+            valid_options = rate(argv[++i], options.secondSiteRate);
+        }
+        else if (option == "--isoschizomer-rate" && has_value) {
+            valid_options = rate(argv[++i], options.isoschizomerRate);
+        }
+        else if (option == "--duplicate-rate" && has_value) {
+            valid_options = rate(argv[++i], options.duplicateRate);
+        }
+        else if (option == "--lengths" && has_value) {
+            valid_options = parseLengths(argv[++i], options);
+        }
+        else {
+            valid_options = false;
+        }
+    }
+
+    if (!valid_options) {
+        cerr << "ERROR: Invalid arguments." << endl;
+        cerr << "Usage: ./genRebase <database file> <queries file> <number of enzymes>" << endl;
+        cerr << "       [--seed N] [--queries N] [--hit-rate P] [--degeneracy P] [--cut-rate P]" << endl;
+        cerr << "       [--second-site-rate P] [--isoschizomer-rate P] [--duplicate-rate P]" << endl;
+        cerr << "       [--lengths LENGTH:WEIGHT,...]" << endl;
+        exit(-1);
+    }
+
+    ofstream database(argv[1]);
+    ofstream queries(argv[2]);
+    if (database.fail() || queries.fail()) {
+        cerr << "ERROR: Could not open output files. Please check your file names and try again." << endl;
+        exit(-1);
+    }
+
+    // Header, which the parser skips as its lines do not end in //
+    string buffer;
+    writeLine(database, buffer, "REBASE synthetic database, seed " + to_string(options.seed) +
+              ", " + to_string(options.enzymes) + " enzymes");
+    writeLine(database, buffer, " ");
+
+    uint64_t records = 0;
+    for (uint64_t e = 0; e < options.enzymes; e++) {
+        writeLine(database, buffer, enzymeRecord(options, e));
+        records++;
+        SiteRandom random(options.seed, e, ENZYME);
+        if (e > 0 && random.uniform() < options.duplicateRate) {
+            writeLine(database, buffer, enzymeRecord(options, random.below(e)));
+            records++;
+        }
+    }
+    database.write(buffer.data(), buffer.size());
+    buffer.clear();
+
+    uint64_t hits = 0;
+    for (uint64_t q = 0; q < options.queries; q++) {
+        SiteRandom random(options.seed, q, QUERY);
+        if (random.uniform() < options.hitRate) {
+            writeLine(queries, buffer, firstSite(options, random.below(options.enzymes)));
+            hits++;
+        }
+        else {
+            writeLine(queries, buffer, randomSite(options, random, 2));
+        }
+    }
+    queries.write(buffer.data(), buffer.size());
+
+    database.close();
+    queries.close();
+    if (database.fail() || queries.fail()) {
+        cerr << "ERROR: Could not write output files." << endl;
+        exit(-1);
+    }
+
+    cout << "Records written: " << records << " for " << options.enzymes << " enzymes" << endl;
+    cout << "Queries written: " << options.queries << " (" << hits << " in the database)" << endl;
+
+    return 0;
+}
@@ -10,6 +10,9 @@
                     Prompts the user for input. User inputs a recognition 
                     sequence and the program will output a list of the enzymes
                     that act on the query sequnce.
+                    With the Pattern flag, the user inputs a DNA fragment and
+                    the program lists every site whose IUPAC pattern matches
+                    it, with the enzymes that act on each.
  
  Last Modified:     March 8, 2015
  
@@ -25,16 +28,45 @@
 #include "AvlTree.h"
 #include "LazyAVLTree.h"
 #include "BinarySearchTree.h"
+#include "SkipList.h"
+#include "Trie.h"
+#include "HashTable.h"
+#include "FrozenSequenceIndex.h"
+#include "IupacPatternIndex.h"
+#include "MappedFile.h"
 #include "TreeParser.h"
 
 using namespace std;
 int main(int argc, const char * argv[]) {
     
-    if (argc !=3){
+    // Optional flags after the required arguments
+    int threads = 0;
+    string snapshot;
+    bool valid_options = true;
+    for (int i = 3; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--threads" && i + 1 < argc && atoi(argv[i + 1]) >= 1) {
+            // Build in parallel
+            threads = atoi(argv[++i]);
+        }
+        else if (option == "--snapshot" && i + 1 < argc) {
+            // Load from, or save to, a binary snapshot
+            snapshot = argv[++i];
+        }
+        else {
+            valid_options = false;
+        }
+    }
+    
+    if (argc < 3){
         // Incorrect number of arguments given in command line
         cerr << "ERROR: Invalid number of arguments." << endl;
         exit(-1);
     }
+    else if (!valid_options) {
+        cerr << "ERROR: Invalid option. Use --threads N with N at least 1, or --snapshot FILE." << endl;
+        exit(-1);
+    }
     else {
         
         string file_name = argv[1];
@@ -43,16 +75,15 @@ int main(int argc, const char * argv[]) {
         // For case insensitive argument comparison
         transform(tree_type.begin(), tree_type.end(), tree_type.begin(), ::tolower);
         
-        // Open file
-        ifstream readf;
-        readf.open(file_name.c_str());
+        // Map file into memory
+        MappedFile readf(file_name);
         
         if (readf.fail()) {
             cerr << "ERROR: Invalid file. Please check your file name and try again." << endl;
             exit(-1);
         }
         
-        if (readf.is_open()) {
+        else {
             
             try {
                 
@@ -60,17 +91,37 @@ int main(int argc, const char * argv[]) {
                 // Prompts user for recognition sequence queries and prints
                 // enzyme acronyms for valid sequences
                 if (tree_type == "bst") {
-                    BinarySearchTree<SequenceMap> bst_tree = parseTree<BinarySearchTree<SequenceMap>>(readf);
+                    BinarySearchTree<SequenceMap> bst_tree = openTree<BinarySearchTree<SequenceMap>>(readf, file_name, threads, snapshot);
                     printSequenceMap(bst_tree);
                 }
                 else if (tree_type == "avl"){
-                    AvlTree<SequenceMap> avl_tree = parseTree<AvlTree<SequenceMap>>(readf);
+                    AvlTree<SequenceMap> avl_tree = openTree<AvlTree<SequenceMap>>(readf, file_name, threads, snapshot);
                     printSequenceMap(avl_tree);
                 }
                 else if (tree_type == "lazyavl") {
-                    LazyAvlTree<SequenceMap> lazy_tree = parseTree<LazyAvlTree<SequenceMap>>(readf);
+                    LazyAvlTree<SequenceMap> lazy_tree = openTree<LazyAvlTree<SequenceMap>>(readf, file_name, threads, snapshot);
                     printSequenceMap(lazy_tree);
                 }
+                else if (tree_type == "skiplist") {
+                    SkipList<SequenceMap> skip_list = openTree<SkipList<SequenceMap>>(readf, file_name, threads, snapshot);
+                    printSequenceMap(skip_list);
+                }
+                else if (tree_type == "trie") {
+                    Trie<SequenceMap> trie = openTree<Trie<SequenceMap>>(readf, file_name, threads, snapshot);
+                    printSequenceMap(trie);
+                }
+                else if (tree_type == "hash") {
+                    HashTable<SequenceMap> hash_table = openTree<HashTable<SequenceMap>>(readf, file_name, threads, snapshot);
+                    printSequenceMap(hash_table);
+                }
+                else if (tree_type == "pattern") {
+                    IupacPatternIndex pattern_index(openTree<AvlTree<SequenceMap>>(readf, file_name, threads, snapshot));
+                    printSequenceMap(pattern_index);
+                }
+                else if (tree_type == "frozen") {
+                    FrozenSequenceIndex frozen_index(openTree<AvlTree<SequenceMap>>(readf, file_name, threads, snapshot));
+                    printSequenceMap(frozen_index);
+                }
                 else {
                     throw invalid_argument(tree_type);
                 }
@@ -94,8 +145,6 @@ int main(int argc, const char * argv[]) {
             }
         }
         
-        readf.close();
-        
     }
     
     return 0;
@@ -0,0 +1,242 @@
+/*****************************************************************************
+ Title:             scanGenome.cpp
+ Created on:        October 18, 2026
+ Description:       Finds where the enzymes in a given database cut a DNA
+                    sequence.
+                    1. Parses a given file of enzymes and recognition
+                    sequences and compiles every site, on both strands,
+                    into a SiteScanner.
+                    2. Streams a given FASTA file once, in chunks of
+                    CHUNK_BYTES. With --threads N, N chunks are scanned at a
+                    time. Each chunk also reads a few bases past its end so
+                    that sites crossing into the next chunk are found, and
+                    owns only the sites that start inside it.
+                    3. Prints one line per site found, in order:
+                        record  position  strand  site  acronyms
+                    Positions start at 1 and are on the forward strand.
+                    With --quiet, prints only the totals.
+                    4. Prints the number of bases scanned per second to
+                    standard error.
+
+ ****************************************************************************/
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <future>
+
+#include "AvlTree.h"
+#include "MappedFile.h"
+#include "SiteScanner.h"
+#include "TreeParser.h"
+
+using namespace std;
+
+// Bytes of FASTA handed to one scan
+static const size_t CHUNK_BYTES = 4 << 20;
+
+/**
+ * A piece of one FASTA record: the sites starting in [begin, ownEnd) belong
+ * to it, and it is scanned up to end to finish sites that run past ownEnd
+ */
+struct Chunk {
+    string_view record;
+    bool recordStart;
+    const char *begin;
+    const char *ownEnd;
+    const char *end;
+};
+
+/**
+ * Sites found in a chunk, and the number of bases the chunk owns
+ */
+struct ChunkResult {
+    vector<SiteHit> hits;
+    long bases;
+};
+
+/**
+ * True if p is the first byte of a line of the file starting at data
+ */
+bool atLineStart(const char *data, const char *p) {
+    return p == data || p[-1] == '\n';
+}
+
+/**
+ * Returns the first header line ('>' at the start of a line) in
+ * [p, limit), or limit if there is none
+ */
+const char *findHeader(const char *data, const char *p, const char *limit) {
+    while (p < limit) {
+        const char *q = static_cast<const char *>(memchr(p, '>', limit - p));
+        if (q == nullptr) {
+            return limit;
+        }
+        if (atLineStart(data, q)) {
+            return q;
+        }
+        p = q + 1;
+    }
+    return limit;
+}
+
+/**
+ * Splits a mapped FASTA file into chunks. Reads the file's header lines on
+ * the way, so the file is read once.
+ */
+class ChunkReader {
+public:
+    ChunkReader(string_view file, int overlap) : data(file.data()), fileEnd(file.data() + file.size()),
+        p(file.data()), overlap(overlap), recordStart(true) { }
+
+    /**
+     * Sets chunk to the next piece of the file. Returns false at end of file
+     */
+    bool next(Chunk &chunk) {
+
+        // Header lines start a new record
+        while (p < fileEnd && atLineStart(data, p) && *p == '>') {
+            const char *eol = static_cast<const char *>(memchr(p, '\n', fileEnd - p));
+            eol = (eol == nullptr) ? fileEnd : eol;
+            const char *name_end = p + 1;
+            while (name_end < eol && !isspace(static_cast<unsigned char>(*name_end))) {
+                name_end++;
+            }
+            record = string_view(p + 1, name_end - p - 1);
+            recordStart = true;
+            p = (eol == fileEnd) ? fileEnd : eol + 1;
+        }
+        if (p >= fileEnd) {
+            return false;
+        }
+
+        const char *limit = (fileEnd - p > static_cast<long>(CHUNK_BYTES)) ? p + CHUNK_BYTES : fileEnd;
+        const char *own_end = findHeader(data, p, limit);
+
+        // Read on until overlap more bases, or the end of the record
+        const char *end = own_end;
+        for (int bases = 0; bases < overlap && end < fileEnd && !(atLineStart(data, end) && *end == '>'); end++) {
+            if (*end != '\n' && *end != '\r') {
+                bases++;
+            }
+        }
+
+        chunk = {record, recordStart, p, own_end, end};
+        recordStart = false;
+        p = own_end;
+        return true;
+    }
+
+private:
+    const char *data;
+    const char *fileEnd;
+    const char *p;
+    int overlap;
+    string_view record;
+    bool recordStart;
+};
+
+int main(int argc, const char * argv[]) {
+
+    // Optional flags after the required arguments
+    int threads = 1;
+    bool quiet = false;
+    bool valid_options = true;
+    for (int i = 3; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--threads" && i + 1 < argc && atoi(argv[i + 1]) >= 1) {
+            threads = atoi(argv[++i]);
+        }
+        else if (option == "--quiet") {
+            quiet = true;
+        }
+        else {
+            valid_options = false;
+        }
+    }
+
+    if (argc < 3 || !valid_options) {
+        cerr << "ERROR: Invalid arguments." << endl;
+        cerr << "Usage: ./scanGenome <database file> <FASTA file> [--threads N] [--quiet]" << endl;
+        exit(-1);
+    }
+
+    MappedFile database(argv[1]);
+    MappedFile fasta(argv[2]);
+    if (database.fail() || fasta.fail()) {
+        cerr << "ERROR: Invalid file. Please check your file name and try again." << endl;
+        exit(-1);
+    }
+
+    SiteScanner scanner(parseTree<AvlTree<SequenceMap>>(database));
+
+    // Acronym list of each pattern, joined once
+    vector<string> acronyms(scanner.patterns());
+    for (int p = 0; p < scanner.patterns(); p++) {
+        for (const string &acronym : scanner.element(p).getAcronyms()) {
+            acronyms[p] += (acronyms[p].empty() ? "" : ",") + acronym;
+        }
+    }
+
+    auto start = chrono::steady_clock::now();
+
+    // Keep up to threads chunks in flight; print them in file order
+    ChunkReader reader(fasta.view(), scanner.longestPattern() - 1);
+    deque<pair<Chunk, future<ChunkResult>>> in_flight;
+    long record_bases = 0;
+    long total_bases = 0;
+    long total_hits = 0;
+    Chunk chunk;
+    bool more = true;
+
+    while (more || !in_flight.empty()) {
+        while (more && static_cast<int>(in_flight.size()) < threads) {
+            more = reader.next(chunk);
+            if (more) {
+                auto scan = [&scanner](Chunk c) {
+                    ChunkResult result;
+                    result.bases = scanner.scan(c.begin, c.end, c.ownEnd, result.hits);
+                    return result;
+                };
+                launch policy = (threads > 1) ? launch::async : launch::deferred;
+                in_flight.push_back(make_pair(chunk, async(policy, scan, chunk)));
+            }
+        }
+        if (in_flight.empty()) {
+            break;
+        }
+
+        Chunk done = in_flight.front().first;
+        ChunkResult result = in_flight.front().second.get();
+        in_flight.pop_front();
+
+        if (done.recordStart) {
+            record_bases = 0;
+        }
+        if (!quiet) {
+            for (const SiteHit &hit : result.hits) {
+                cout << done.record << '\t' << record_bases + hit.position + 1 << '\t'
+                     << scanner.strand(hit.pattern) << '\t' << scanner.element(hit.pattern).getSequence()
+                     << '\t' << acronyms[hit.pattern] << '\n';
+            }
+        }
+        record_bases += result.bases;
+        total_bases += result.bases;
+        total_hits += result.hits.size();
+    }
+    cout.flush();
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cerr << "Patterns: " << scanner.patterns() << ", automaton states: " << scanner.states() << endl;
+    cerr << "Scanned " << total_bases << " bases in " << elapsed.count() << " s ("
+         << total_bases / elapsed.count() << " bases/s) with " << threads << " thread(s), "
+         << total_hits << " sites found" << endl;
+
+    return 0;
+}
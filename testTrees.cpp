@@ -20,6 +20,12 @@
                     the tree and prints the number of sequences removed and
                     the number of recursive calls made to remove.
                     5. Runs tests in 2. and 3. again on the diminished tree.
+                    6. For the tree with lazy deletion, shows the live and
+                    deleted node counts and the average depth before and
+                    after compacting the tree.
+                    7. With --perf, prints the wall time and hardware
+                    counters of parsing, each search and the removes, in
+                    total and per operation.
  
  Last Modified:     March 8, 2015
  
@@ -31,22 +37,60 @@
 #include <cstdlib>
 #include <string>
 #include <vector>
+#include <memory>
 #include <ctype.h>
 
 #include "AvlTree.h"
 #include "LazyAVLTree.h"
 #include "BinarySearchTree.h"
+#include "SkipList.h"
+#include "Trie.h"
+#include "HashTable.h"
+#include "BPlusTree.h"
+#include "MappedFile.h"
 #include "TreeParser.h"
 #include "TestRoutines.h"
 
 using namespace std;
 int main(int argc, const char * argv[]) {
     
-    if (argc !=4){
+    // Optional flags after the required arguments
+    int threads = 0;
+    string snapshot;
+    bool batch = false;
+    unique_ptr<PerfCounters> perf;
+    bool valid_options = true;
+    for (int i = 4; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--threads" && i + 1 < argc && atoi(argv[i + 1]) >= 1) {
+            // Build in parallel
+            threads = atoi(argv[++i]);
+        }
+        else if (option == "--snapshot" && i + 1 < argc) {
+            // Load from, or save to, a binary snapshot
+            snapshot = argv[++i];
+        }
+        else if (option == "--batch") {
+            batch = true;
+        }
+        else if (option == "--perf") {
+            // Count hardware events in each phase
+            perf.reset(new PerfCounters());
+        }
+        else {
+            valid_options = false;
+        }
+    }
+    
+    if (argc < 4){
         // Incorrect number of arguments given in command line
         cerr << "ERROR: Invalid number of arguments." << endl;
         exit(-1);
     }
+    else if (!valid_options) {
+        cerr << "ERROR: Invalid option. Use --threads N with N at least 1, --batch, --perf, or --snapshot FILE." << endl;
+        exit(-1);
+    }
     else {
         
         string file_to_parse = argv[1];
@@ -56,16 +100,15 @@ int main(int argc, const char * argv[]) {
         // For case insensitive argument comparison
         transform(tree_type.begin(), tree_type.end(), tree_type.begin(), ::tolower);
         
-        // Open file
-        ifstream parsef;
-        parsef.open(file_to_parse.c_str());
+        // Map file into memory
+        MappedFile parsef(file_to_parse);
         
         if (parsef.fail()) {
             cerr << "ERROR: Invalid file. Please check your file name and try again." << endl;
             exit(-1);
         }
         
-        if (parsef.is_open()) {
+        else {
             
             try {
                 
@@ -74,42 +117,147 @@ int main(int argc, const char * argv[]) {
                 // Create tree from file and run test routine
                 
                 if (tree_type == "bst") {
-                    BinarySearchTree<SequenceMap> bst_tree = parseTree<BinarySearchTree<SequenceMap>>(parsef, insert_count);
+                    BinarySearchTree<SequenceMap> bst_tree = measureOpenTree<BinarySearchTree<SequenceMap>>(parsef, file_to_parse, threads, snapshot, perf.get());
                     cout << "\nBinary Search Tree Created..." << endl;
                     
                     cout << "===============================" << endl;
                     cout << "BINARY SEARCH TREE TEST RESULTS" << endl;
                     cout << "===============================" << endl;
                     
+                    printPhaseCounters("parse", perf.get(), countSequences(parsef), "sequence");
+                    compareBuildTimes<BinarySearchTree<SequenceMap>>(file_to_parse, insert_count);
                     cout << "Total number of recursive calls to insert: " << insert_count << endl;
+                    if (threads > 0) {
+                        compareParallelBuildTimes<BinarySearchTree<SequenceMap>>(file_to_parse, threads);
+                    }
                     
-                    runTestRoutine(bst_tree, seq_query_file);
+                    runTestRoutine(bst_tree, seq_query_file, batch, perf.get());
                     
                 }
                 else if (tree_type == "avl"){
-                    AvlTree<SequenceMap> avl_tree = parseTree<AvlTree<SequenceMap>>(parsef, insert_count);
+                    AvlTree<SequenceMap> avl_tree = measureOpenTree<AvlTree<SequenceMap>>(parsef, file_to_parse, threads, snapshot, perf.get());
                     cout << "\nAVL Tree Created..." << endl;
                     
                     cout << "===============================" << endl;
                     cout << "AVL TREE TEST RESULTS" << endl;
                     cout << "===============================" << endl;
                     
+                    printPhaseCounters("parse", perf.get(), countSequences(parsef), "sequence");
+                    compareBuildTimes<AvlTree<SequenceMap>>(file_to_parse, insert_count);
                     cout << "Total number of recursive calls to insert: " << insert_count << endl;
+                    if (threads > 0) {
+                        compareParallelBuildTimes<AvlTree<SequenceMap>>(file_to_parse, threads);
+                    }
 
-                    runTestRoutine(avl_tree, seq_query_file);
+                    runTestRoutine(avl_tree, seq_query_file, batch, perf.get());
 
                 }
                 else if (tree_type == "lazyavl") {
-                    LazyAvlTree<SequenceMap> lazy_tree = parseTree<LazyAvlTree<SequenceMap>>(parsef, insert_count);
+                    LazyAvlTree<SequenceMap> lazy_tree = measureOpenTree<LazyAvlTree<SequenceMap>>(parsef, file_to_parse, threads, snapshot, perf.get());
                     cout << "\nAVL Tree with Lazy Deletion Created..." << endl;
                     
                     cout << "===============================" << endl;
                     cout << "LAZY AVL TREE TEST RESULTS" << endl;
                     cout << "===============================" << endl;
                     
+                    printPhaseCounters("parse", perf.get(), countSequences(parsef), "sequence");
+                    compareBuildTimes<LazyAvlTree<SequenceMap>>(file_to_parse, insert_count);
                     cout << "Total number of recursive calls to insert: " << insert_count << endl;
+                    if (threads > 0) {
+                        compareParallelBuildTimes<LazyAvlTree<SequenceMap>>(file_to_parse, threads);
+                    }
 
-                    runTestRoutine(lazy_tree, seq_query_file);
+                    runTestRoutine(lazy_tree, seq_query_file, batch, perf.get());
+                    
+                    cout << "--------------------" << endl;
+                    reportCompaction(lazy_tree);
+
+                }
+                else if (tree_type == "skiplist") {
+                    SkipList<SequenceMap> skip_list = measureOpenTree<SkipList<SequenceMap>>(parsef, file_to_parse, threads, snapshot, perf.get());
+                    cout << "\nSkip List Created..." << endl;
+                    
+                    cout << "===============================" << endl;
+                    cout << "SKIP LIST TEST RESULTS" << endl;
+                    cout << "===============================" << endl;
+                    
+                    printPhaseCounters("parse", perf.get(), countSequences(parsef), "sequence");
+                    compareBuildTimes<SkipList<SequenceMap>>(file_to_parse, insert_count);
+                    cout << "Total number of recursive calls to insert: " << insert_count << endl;
+                    if (threads > 0) {
+                        compareParallelBuildTimes<SkipList<SequenceMap>>(file_to_parse, threads);
+                    }
+
+                    runTestRoutine(skip_list, seq_query_file, batch, perf.get());
+
+                }
+                else if (tree_type == "hash") {
+                    HashTable<SequenceMap> hash_table = measureOpenTree<HashTable<SequenceMap>>(parsef, file_to_parse, threads, snapshot, perf.get());
+                    cout << "\nHash Table Created..." << endl;
+                    
+                    cout << "===============================" << endl;
+                    cout << "HASH TABLE TEST RESULTS" << endl;
+                    cout << "===============================" << endl;
+                    
+                    printPhaseCounters("parse", perf.get(), countSequences(parsef), "sequence");
+                    compareBuildTimes<HashTable<SequenceMap>>(file_to_parse, insert_count);
+                    cout << "Total number of recursive calls to insert: " << insert_count << endl;
+                    if (threads > 0) {
+                        compareParallelBuildTimes<HashTable<SequenceMap>>(file_to_parse, threads);
+                    }
+                    cout << "Hash table slots: " << hash_table.capacity() << endl;
+
+                    runTestRoutine(hash_table, seq_query_file, batch, perf.get());
+
+                }
+                else if (tree_type == "trie") {
+                    Trie<SequenceMap> trie = measureOpenTree<Trie<SequenceMap>>(parsef, file_to_parse, threads, snapshot, perf.get());
+                    cout << "\nTrie Created..." << endl;
+                    
+                    cout << "===============================" << endl;
+                    cout << "TRIE TEST RESULTS" << endl;
+                    cout << "===============================" << endl;
+                    
+                    printPhaseCounters("parse", perf.get(), countSequences(parsef), "sequence");
+                    compareBuildTimes<Trie<SequenceMap>>(file_to_parse, insert_count);
+                    cout << "Total number of recursive calls to insert: " << insert_count << endl;
+                    if (threads > 0) {
+                        compareParallelBuildTimes<Trie<SequenceMap>>(file_to_parse, threads);
+                    }
+                    cout << "Trie nodes, including branch nodes: " << trie.trieNodes() << endl;
+                    
+                    cout << "--------------------" << endl;
+                    cout << "...Comparing searches with AVL tree...\n" << endl;
+                    AvlTree<SequenceMap> avl_tree = parseTreeParallel<AvlTree<SequenceMap>>(parsef, threads);
+                    compareSearches(trie, "Trie", avl_tree, "AVL tree", seq_query_file);
+                    
+                    cout << "--------------------" << endl;
+                    runTestRoutine(trie, seq_query_file, batch, perf.get());
+
+                }
+                else if (tree_type == "bplustree") {
+                    BPlusTree<SequenceMap> bplus_tree = measureOpenTree<BPlusTree<SequenceMap>>(parsef, file_to_parse, threads, snapshot, perf.get());
+                    cout << "\nB+ Tree Created..." << endl;
+                    
+                    cout << "===============================" << endl;
+                    cout << "B+ TREE TEST RESULTS" << endl;
+                    cout << "===============================" << endl;
+                    
+                    printPhaseCounters("parse", perf.get(), countSequences(parsef), "sequence");
+                    compareBuildTimes<BPlusTree<SequenceMap>>(file_to_parse, insert_count);
+                    cout << "Total number of recursive calls to insert: " << insert_count << endl;
+                    if (threads > 0) {
+                        compareParallelBuildTimes<BPlusTree<SequenceMap>>(file_to_parse, threads);
+                    }
+                    cout << "B+ tree nodes, inner and leaf: " << bplus_tree.treeNodes() << endl;
+                    
+                    cout << "--------------------" << endl;
+                    cout << "...Comparing searches with AVL tree...\n" << endl;
+                    AvlTree<SequenceMap> avl_tree = parseTreeParallel<AvlTree<SequenceMap>>(parsef, threads);
+                    compareSearches(bplus_tree, "B+ tree", avl_tree, "AVL tree", seq_query_file);
+                    
+                    cout << "--------------------" << endl;
+                    runTestRoutine(bplus_tree, seq_query_file, batch, perf.get());
 
                 }
 
@@ -136,9 +284,6 @@ int main(int argc, const char * argv[]) {
             }
         }
         
-        // Close file
-        parsef.close();
-        
     }
     
     return 0;